@@ -0,0 +1,535 @@
+#include "Benchmark.h"
+#include "Render.h"
+#include "VertexBufferLayout.h"
+#include "Framebuffer.h"
+#include "StreamingBuffer.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+
+static std::atomic<unsigned long long> s_Allocations(0);
+static std::atomic<bool> s_CountAllocations(false);
+
+//counting replacements for the global allocator, array forms forward to these.
+//Standard C++ has no other hook that sees every heap allocation, and a custom
+//allocator would only cover the containers that opt in. Outside Benchmark::Run
+//the cost is one relaxed load; only measured frames of --bench are counted.
+//On Linux the replacement also interposes the driver's C++ allocations.
+void* operator new(size_t size)
+{
+	if (s_CountAllocations.load(std::memory_order_relaxed))
+		s_Allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+unsigned long long Benchmark::GetAllocationCount()
+{
+	return s_Allocations.load(std::memory_order_relaxed);
+}
+
+//one small triangle per object, placed on a grid so objects do not fully overlap
+struct BenchmarkMesh
+{
+	std::unique_ptr<VertexArray> va;
+	std::unique_ptr<VertexBuffer> vb;
+	std::unique_ptr<IndexBuffer> ib;
+};
+
+//with arenas the mesh's buffers are ranges of shared GL buffers and it gets no VAO of its own
+static BenchmarkMesh CreateMesh(unsigned int i, BufferArena* vertexArena = nullptr, BufferArena* indexArena = nullptr)
+{
+	float x = (i % 64) / 32.0f - 1.0f;
+	float y = (i / 64 % 64) / 32.0f - 1.0f;
+	float vertices[] = {
+		x, y, 0.0f,
+		x + 0.03f, y, 0.0f,
+		x, y + 0.03f, 0.0f
+	};
+	unsigned int indices[] = { 0, 1, 2 };
+
+	BenchmarkMesh mesh;
+	if (vertexArena && indexArena)
+	{
+		mesh.vb.reset(new VertexBuffer(*vertexArena, vertices, sizeof(vertices), 3 * sizeof(float)));
+		mesh.ib.reset(new IndexBuffer(*indexArena, indices, 3));
+		return mesh;
+	}
+
+	mesh.va.reset(new VertexArray());
+	mesh.vb.reset(new VertexBuffer(vertices, sizeof(vertices)));
+	mesh.ib.reset(new IndexBuffer(indices, 3));
+
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	mesh.va->AddBuffer(*mesh.vb, layout);
+	return mesh;
+}
+
+Benchmark::Benchmark(unsigned int frames)
+	:m_Frames(frames), m_WarmupFrames(10)
+{
+}
+
+void Benchmark::RunAll()
+{
+	Framebuffer target(256, 256);
+	target.Bind();
+
+	RunDrawScenario(4000, 16, false);
+	RunDrawScenario(4000, 16, true);
+	RunArenaScenario(4000, 16);
+	RunUniformScenario(4000);
+	RunBufferCreationScenario(500);
+	RunStreamScenario(10000);
+	RunUpdateScenario(BufferUsage::Stream, BufferUpdateStrategy::SubData, 64, 1024);
+	RunUpdateScenario(BufferUsage::Stream, BufferUpdateStrategy::Orphan, 64, 1024);
+	RunUpdateScenario(BufferUsage::Stream, BufferUpdateStrategy::MapInvalidate, 64, 1024);
+	RunUpdateScenario(BufferUsage::Stream, BufferUpdateStrategy::MapUnsynchronized, 64, 1024);
+	RunLayoutScenario(10000);
+	RunMeshOptimizeScenario(64);
+
+	target.UnBind();
+}
+
+void Benchmark::Run(const std::string& name, unsigned int itemsPerFrame, const std::function<void()>& frame)
+{
+	for (unsigned int i = 0; i < m_WarmupFrames; i++)
+		frame();
+	GLCall(glFinish());
+
+	double cpuNs = 0.0;
+	unsigned long long allocations = 0;
+	unsigned long long glCalls = 0;
+	for (unsigned int i = 0; i < m_Frames; i++)
+	{
+		unsigned long long allocsBefore = GetAllocationCount();
+		unsigned long long callsBefore = GLDebug::GetCallCount();
+		auto start = std::chrono::high_resolution_clock::now();
+
+		s_CountAllocations.store(true, std::memory_order_relaxed);
+		frame();
+		s_CountAllocations.store(false, std::memory_order_relaxed);
+
+		auto end = std::chrono::high_resolution_clock::now();
+		cpuNs += std::chrono::duration<double, std::nano>(end - start).count();
+		allocations += GetAllocationCount() - allocsBefore;
+		glCalls += GLDebug::GetCallCount() - callsBefore;
+
+		//keep the GPU from queueing up frames, outside the timed region
+		GLCall(glFinish());
+	}
+
+	double items = (double)itemsPerFrame * m_Frames;
+	m_Results.push_back({ name, m_Frames, itemsPerFrame, cpuNs / items, (double)allocations / m_Frames,
+		GLDebug::IsCountingCalls() ? glCalls / items : -1.0 });
+}
+
+void Benchmark::RunDrawScenario(unsigned int objects, unsigned int shaders, bool sorted)
+{
+	std::vector<BenchmarkMesh> meshes;
+	meshes.reserve(objects);
+	for (unsigned int i = 0; i < objects; i++)
+		meshes.push_back(CreateMesh(i));
+
+	std::vector<std::unique_ptr<Shader>> programs;
+	for (unsigned int i = 0; i < shaders; i++)
+		programs.emplace_back(new Shader("res/shaders/Basic.shader"));
+
+	Render renderer;
+	//objects cycle through the shaders, the worst order for unsorted submission
+	Run(sorted ? "draw_sorted" : "draw", objects, [&]()
+	{
+		for (unsigned int i = 0; i < objects; i++)
+		{
+			const BenchmarkMesh& mesh = meshes[i];
+			const Shader& shader = *programs[i % shaders];
+			if (sorted)
+				renderer.Submit(*mesh.va, *mesh.ib, shader);
+			else
+				renderer.Draw(*mesh.va, *mesh.ib, shader);
+		}
+		if (sorted)
+			renderer.Flush();
+	});
+}
+
+void Benchmark::RunArenaScenario(unsigned int objects, unsigned int shaders)
+{
+	//small pages keep the scenario honest about crossing page boundaries
+	BufferArena vertexArena(64 * 1024);
+	BufferArena indexArena(64 * 1024);
+	std::vector<BenchmarkMesh> meshes;
+	meshes.reserve(objects);
+	for (unsigned int i = 0; i < objects; i++)
+		meshes.push_back(CreateMesh(i, &vertexArena, &indexArena));
+
+	//one VAO per pair of pages, meshes in the same pages share it
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	std::map<std::pair<unsigned int, unsigned int>, std::unique_ptr<VertexArray>> arrays;
+	std::vector<const VertexArray*> meshArrays(objects);
+	for (unsigned int i = 0; i < objects; i++)
+	{
+		auto& va = arrays[{ meshes[i].vb->GetRendererID(), meshes[i].ib->GetRendererID() }];
+		if (!va)
+		{
+			va.reset(new VertexArray());
+			va->AddBuffer(*meshes[i].vb, layout);
+			meshes[i].ib->Bind();
+		}
+		meshArrays[i] = va.get();
+	}
+
+	std::vector<std::unique_ptr<Shader>> programs;
+	for (unsigned int i = 0; i < shaders; i++)
+		programs.emplace_back(new Shader("res/shaders/Basic.shader"));
+
+	Render renderer;
+	Run("draw_arena", objects, [&]()
+	{
+		for (unsigned int i = 0; i < objects; i++)
+		{
+			const BenchmarkMesh& mesh = meshes[i];
+			renderer.Submit(*meshArrays[i], *mesh.ib, *programs[i % shaders], 0, 0.0f, mesh.vb->GetBaseVertex());
+		}
+		renderer.Flush();
+	});
+}
+
+void Benchmark::RunUniformScenario(unsigned int draws)
+{
+	BenchmarkMesh mesh = CreateMesh(0);
+	Shader shader("res/shaders/Basic.shader");
+	Render renderer;
+
+	static constexpr UniformName ColorName = "u_Color"_u;
+	Uniform<Vec4> colorUniform = shader.GetUniform<Vec4>(ColorName);
+
+	Run("uniforms", draws, [&]()
+	{
+		shader.Bind();
+		for (unsigned int i = 0; i < draws; i++)
+		{
+			shader.SetUniform(colorUniform, Vec4{ (i % 256) / 255.0f, 0.3f, 0.8f, 1.0f });
+			renderer.Draw(*mesh.va, *mesh.ib, shader);
+		}
+	});
+}
+
+void Benchmark::RunBufferCreationScenario(unsigned int buffers)
+{
+	float vertices[9] = { 0 };
+	unsigned int indices[] = { 0, 1, 2 };
+
+	Run("buffer_create", buffers, [&]()
+	{
+		for (unsigned int i = 0; i < buffers; i++)
+		{
+			VertexBuffer vb(vertices, sizeof(vertices));
+			IndexBuffer ib(indices, 3);
+		}
+	});
+}
+
+void Benchmark::RunStreamScenario(unsigned int particles)
+{
+	//one triangle per particle, rewritten every frame like a particle system would
+	const unsigned int stride = 3 * sizeof(float);
+	const unsigned int frameSize = particles * 3 * stride;
+	StreamingBuffer stream(frameSize);
+	VertexArray va;
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	va.AddBuffer(stream, layout);
+
+	Shader shader("res/shaders/Basic.shader");
+	Render renderer;
+	unsigned int frame = 0;
+
+	Run("stream", particles, [&]()
+	{
+		float* vertices = (float*)stream.Map(frameSize, stride);
+		float phase = (frame++ % 64) / 64.0f;
+		for (unsigned int i = 0; i < particles; i++)
+		{
+			float x = (i % 100) / 50.0f - 1.0f + phase * 0.02f;
+			float y = (i / 100 % 100) / 50.0f - 1.0f;
+			float* v = vertices + i * 9;
+			v[0] = x;         v[1] = y;         v[2] = 0.0f;
+			v[3] = x + 0.01f; v[4] = y;         v[5] = 0.0f;
+			v[6] = x;         v[7] = y + 0.01f; v[8] = 0.0f;
+		}
+		unsigned int offset = stream.Unmap();
+
+		renderer.DrawArrays(va, shader, offset / stride, particles * 3);
+		stream.NextFrame();
+	});
+	if (stream.GetStallCount())
+		std::cout << "[Benchmark] stream waited on the GPU " << stream.GetStallCount() << " times" << std::endl;
+}
+
+void Benchmark::RunUpdateScenario(BufferUsage usage, BufferUpdateStrategy strategy, unsigned int buffers,
+	unsigned int vertices)
+{
+	//rewritten and drawn every frame like animated UI, each buffer is still in use by the last frame's draw
+	std::vector<float> data(vertices * 3, 0.0f);
+	std::vector<unsigned int> indices(vertices);
+	for (unsigned int i = 0; i < vertices; i++)
+		indices[i] = i;
+
+	//an unsynchronized map must not touch what a queued draw still reads, so every strategy cycles
+	//through three copies of each buffer and waits on the fence of the copy it reuses, as
+	//StreamingBuffer does; only the upload call differs between them. The copies are separate
+	//buffers so Orphan still replaces a whole buffer instead of falling back to MapInvalidate
+	const unsigned int regions = 3;
+	unsigned int size = (unsigned int)(data.size() * sizeof(float));
+	std::vector<GLsync> fences(regions, nullptr);
+
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	//region major: the copies of buffer i are meshes[region * buffers + i]
+	std::vector<BenchmarkMesh> meshes(buffers * regions);
+	for (BenchmarkMesh& mesh : meshes)
+	{
+		mesh.va.reset(new VertexArray());
+		mesh.vb.reset(new VertexBuffer(nullptr, size, usage));
+		mesh.vb->SetUpdateStrategy(strategy);
+		mesh.ib.reset(new IndexBuffer(indices.data(), vertices));
+		mesh.va->AddBuffer(*mesh.vb, layout);
+	}
+
+	Shader shader("res/shaders/Basic.shader");
+	Render renderer;
+	unsigned int frame = 0;
+
+	Run(std::string("update_") + GetBufferUpdateStrategyName(strategy), buffers, [&]()
+	{
+		unsigned int region = frame % regions;
+		if (fences[region])
+		{
+			GLenum result;
+			GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+			do
+			{
+				GLCall(result = glClientWaitSync(fences[region], flags, 1000000));
+				flags = 0;
+			} while (result == GL_TIMEOUT_EXPIRED);
+			GLCall(glDeleteSync(fences[region]));
+			fences[region] = nullptr;
+		}
+
+		float phase = (frame++ % 64) / 64.0f;
+		for (unsigned int i = 0; i < buffers; i++)
+		{
+			for (unsigned int v = 0; v < vertices; v++)
+			{
+				data[v * 3 + 0] = (v % 32) / 16.0f - 1.0f + phase * 0.01f;
+				data[v * 3 + 1] = (v / 32 % 32) / 16.0f - 1.0f + i * 0.001f;
+			}
+			BenchmarkMesh& mesh = meshes[region * buffers + i];
+			mesh.vb->Update(data.data(), size);
+			renderer.Draw(*mesh.va, *mesh.ib, shader);
+		}
+
+		GLCall(fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	});
+
+	for (GLsync fence : fences)
+	{
+		if (fence)
+		{
+			GLCall(glDeleteSync(fence));
+		}
+	}
+}
+
+void Benchmark::RunLayoutScenario(unsigned int layouts)
+{
+	unsigned int stride = 0;
+	Run("layout_push", layouts, [&]()
+	{
+		for (unsigned int i = 0; i < layouts; i++)
+		{
+			VertexBufferLayout layout;
+			layout.Push<float>(3);
+			layout.Push<float>(2);
+			layout.Push<unsigned char>(4);
+			stride += layout.GetStride();
+		}
+	});
+	//keeps the layouts from being optimized away
+	if (stride == 0)
+		std::cout << "layout_push produced no layouts" << std::endl;
+}
+
+void Benchmark::RunMeshOptimizeScenario(unsigned int gridSize)
+{
+	//a grid with its triangles in random order, the worst case for the vertex cache
+	std::vector<float> sourceVertices;
+	for (unsigned int y = 0; y <= gridSize; y++)
+	{
+		for (unsigned int x = 0; x <= gridSize; x++)
+		{
+			sourceVertices.push_back((float)x / gridSize * 2.0f - 1.0f);
+			sourceVertices.push_back((float)y / gridSize * 2.0f - 1.0f);
+			sourceVertices.push_back(0.0f);
+		}
+	}
+	std::vector<unsigned int> quads(gridSize * gridSize);
+	for (unsigned int i = 0; i < quads.size(); i++)
+		quads[i] = i;
+	std::shuffle(quads.begin(), quads.end(), std::mt19937(1));
+
+	std::vector<unsigned int> sourceIndices;
+	for (unsigned int quad : quads)
+	{
+		unsigned int a = quad / gridSize * (gridSize + 1) + quad % gridSize;
+		unsigned int c = a + gridSize + 1;
+		unsigned int quadIndices[] = { a, a + 1, c, a + 1, c + 1, c };
+		sourceIndices.insert(sourceIndices.end(), quadIndices, quadIndices + 6);
+	}
+
+	unsigned int vertexCount = (unsigned int)sourceVertices.size() / 3;
+	unsigned int indexCount = (unsigned int)sourceIndices.size();
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	MeshOptimizeReport report = {};
+
+	Run("mesh_optimize", indexCount / 3, [&]()
+	{
+		vertices = sourceVertices;
+		indices = sourceIndices;
+		report = MeshOptimizer::Optimize(vertices.data(), vertexCount, 3 * sizeof(float), indices.data(), indexCount);
+	});
+
+	std::cout << "[Benchmark] mesh_optimize ACMR " << report.Before.ACMR << " -> " << report.After.ACMR
+		<< ", ATVR " << report.Before.ATVR << " -> " << report.After.ATVR << std::endl;
+
+	//the passes may only reorder: the same triangles with the same winding must come out, compared
+	//by position since vertices are renumbered, each starting at its smallest corner
+	auto getTriangles = [](const std::vector<float>& positions, const std::vector<unsigned int>& triangleIndices)
+	{
+		std::vector<std::array<float, 9>> triangles;
+		for (size_t t = 0; t + 2 < triangleIndices.size(); t += 3)
+		{
+			const float* corners[3];
+			for (unsigned int k = 0; k < 3; k++)
+				corners[k] = &positions[triangleIndices[t + k] * 3];
+			unsigned int first = 0;
+			for (unsigned int k = 1; k < 3; k++)
+			{
+				if (std::lexicographical_compare(corners[k], corners[k] + 3, corners[first], corners[first] + 3))
+					first = k;
+			}
+			std::array<float, 9> triangle;
+			for (unsigned int k = 0; k < 3; k++)
+				std::copy(corners[(first + k) % 3], corners[(first + k) % 3] + 3, &triangle[k * 3]);
+			triangles.push_back(triangle);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	};
+	bool preserved = getTriangles(sourceVertices, sourceIndices) == getTriangles(vertices, indices);
+	if (!preserved)
+		std::cerr << "[Benchmark] ERROR: mesh_optimize changed the mesh's triangles" << std::endl;
+	ASSERT(preserved);
+}
+
+std::string Benchmark::ToJson() const
+{
+	std::stringstream ss;
+	ss << "[";
+	for (size_t i = 0; i < m_Results.size(); i++)
+	{
+		const BenchmarkResult& r = m_Results[i];
+		ss << (i ? ",\n" : "\n") << "{\"name\":\"" << r.Name << "\""
+			<< ",\"frames\":" << r.Frames
+			<< ",\"items_per_frame\":" << r.ItemsPerFrame
+			<< ",\"cpu_ns_per_item\":" << r.CpuNsPerItem
+			<< ",\"allocs_per_frame\":" << r.AllocsPerFrame
+			<< ",\"gl_calls_per_item\":" << r.GLCallsPerItem << "}";
+	}
+	ss << "\n]";
+	return ss.str();
+}
+
+bool Benchmark::WriteBaseline(const std::string& filePath) const
+{
+	std::ofstream stream(filePath);
+	if (!stream)
+		return false;
+
+	stream << "#name cpu_ns_per_item allocs_per_frame gl_calls_per_item\n";
+	for (const BenchmarkResult& r : m_Results)
+		stream << r.Name << " " << r.CpuNsPerItem << " " << r.AllocsPerFrame << " " << r.GLCallsPerItem << "\n";
+	return true;
+}
+
+unsigned int Benchmark::CompareBaseline(const std::string& filePath, double tolerance) const
+{
+	std::ifstream stream(filePath);
+	if (!stream)
+	{
+		//a missing baseline must not pass silently, count it as a regression of every scenario
+		std::cerr << "[Benchmark] ERROR: cannot read baseline " << filePath
+			<< ", run with --write-baseline to create one" << std::endl;
+		return (unsigned int)m_Results.size();
+	}
+
+	std::map<std::string, BenchmarkResult> baseline;
+	std::string line;
+	while (getline(stream, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::stringstream ss(line);
+		BenchmarkResult r = {};
+		ss >> r.Name >> r.CpuNsPerItem >> r.AllocsPerFrame >> r.GLCallsPerItem;
+		baseline[r.Name] = r;
+	}
+
+	//time is noisy and gets the tolerance, allocations and GL calls are deterministic
+	unsigned int regressions = 0;
+	for (const BenchmarkResult& r : m_Results)
+	{
+		auto it = baseline.find(r.Name);
+		if (it == baseline.end())
+		{
+			std::cerr << "[Benchmark] WARNING: " << r.Name << " is not in the baseline " << filePath
+				<< ", rerun with --write-baseline" << std::endl;
+			continue;
+		}
+		const BenchmarkResult& b = it->second;
+
+		bool slower = r.CpuNsPerItem > b.CpuNsPerItem * (1.0 + tolerance);
+		bool moreAllocs = r.AllocsPerFrame > b.AllocsPerFrame;
+		bool moreCalls = r.GLCallsPerItem >= 0.0 && b.GLCallsPerItem >= 0.0 && r.GLCallsPerItem > b.GLCallsPerItem;
+		if (slower || moreAllocs || moreCalls)
+		{
+			std::cerr << "[Benchmark] REGRESSION in " << r.Name
+				<< ": cpu_ns_per_item " << b.CpuNsPerItem << " -> " << r.CpuNsPerItem
+				<< ", allocs_per_frame " << b.AllocsPerFrame << " -> " << r.AllocsPerFrame
+				<< ", gl_calls_per_item " << b.GLCallsPerItem << " -> " << r.GLCallsPerItem << std::endl;
+			regressions++;
+		}
+	}
+	return regressions;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "BufferUpdate.h"
+
+struct BenchmarkResult
+{
+	std::string Name;
+	unsigned int Frames;
+	unsigned int ItemsPerFrame;
+	double CpuNsPerItem;
+	double AllocsPerFrame;
+	//negative when GLCall counting is compiled out
+	double GLCallsPerItem;
+};
+
+// Throughput scenarios over the renderer's hot paths. Each scenario runs a
+// number of frames against the current context and reports CPU time and GL
+// calls per item (a draw, an upload, a layout) and heap allocations per frame.
+// Results can be saved as a baseline and later runs compared against it.
+class Benchmark
+{
+private:
+	unsigned int m_Frames;
+	unsigned int m_WarmupFrames;
+	std::vector<BenchmarkResult> m_Results;
+
+public:
+	Benchmark(unsigned int frames);
+
+	void RunAll();
+
+	//returns the number of scenarios that got slower than the baseline allows,
+	//every scenario counts when the baseline cannot be read
+	unsigned int CompareBaseline(const std::string& filePath, double tolerance) const;
+	bool WriteBaseline(const std::string& filePath) const;
+
+	std::string ToJson() const;
+	inline const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+
+	//heap allocations made through operator new inside measured benchmark frames
+	static unsigned long long GetAllocationCount();
+
+private:
+	void Run(const std::string& name, unsigned int itemsPerFrame, const std::function<void()>& frame);
+
+	void RunDrawScenario(unsigned int objects, unsigned int shaders, bool sorted);
+	void RunArenaScenario(unsigned int objects, unsigned int shaders);
+	void RunUniformScenario(unsigned int draws);
+	void RunBufferCreationScenario(unsigned int buffers);
+	void RunStreamScenario(unsigned int particles);
+	void RunUpdateScenario(BufferUsage usage, BufferUpdateStrategy strategy, unsigned int buffers, unsigned int vertices);
+	void RunLayoutScenario(unsigned int layouts);
+	void RunMeshOptimizeScenario(unsigned int gridSize);
+};
@@ -0,0 +1,155 @@
+#include "BufferArena.h"
+#include "Render.h"
+#include "GLState.h"
+
+BufferArena::BufferArena(unsigned int pageSize, BufferUsage usage)
+	:m_PageSize(pageSize), m_Usage(usage)
+{
+}
+
+BufferArena::~BufferArena()
+{
+	for (Page& page : m_Pages)
+	{
+		GLState::OnDeleteBuffer(page.RendererID);
+		GLCall(glDeleteBuffers(1, &page.RendererID));
+	}
+}
+
+BufferRange BufferArena::Allocate(unsigned int size, unsigned int alignment)
+{
+	if (alignment == 0)
+		alignment = 1;
+
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < m_Pages.size(); i++)
+	{
+		if (AllocateFrom(m_Pages[i], size, alignment, offset))
+			return { i, offset, size };
+	}
+
+	//oversized requests get an exact page so they do not waste a whole default one
+	unsigned int page = CreatePage(size > m_PageSize ? size : m_PageSize);
+	AllocateFrom(m_Pages[page], size, alignment, offset);
+	return { page, offset, size };
+}
+
+void BufferArena::Free(const BufferRange& range)
+{
+	if (range.Size == 0)
+		return;
+
+	Page& page = m_Pages[range.Page];
+	page.Used -= range.Size;
+
+	unsigned int offset = range.Offset;
+	unsigned int size = range.Size;
+
+	//merge with the free range right after this one
+	auto next = page.Free.find(offset + size);
+	if (next != page.Free.end())
+	{
+		size += next->second;
+		RemoveFree(page, next);
+	}
+
+	//and with the one right before it
+	auto prev = page.Free.lower_bound(offset);
+	if (prev != page.Free.begin())
+	{
+		--prev;
+		if (prev->first + prev->second == offset)
+		{
+			offset = prev->first;
+			size += prev->second;
+			RemoveFree(page, prev);
+		}
+	}
+
+	AddFree(page, offset, size);
+}
+
+void BufferArena::Upload(const BufferRange& range, unsigned int offset, const void* data, unsigned int size,
+	BufferUpdateStrategy strategy)
+{
+	if (!data || size == 0)
+		return;
+
+	const Page& page = m_Pages[range.Page];
+	UpdateBuffer(page.RendererID, page.Size, range.Offset + offset, data, size, m_Usage, strategy);
+}
+
+unsigned int BufferArena::GetUsedSize() const
+{
+	unsigned int used = 0;
+	for (const Page& page : m_Pages)
+		used += page.Used;
+	return used;
+}
+
+unsigned int BufferArena::GetFreeRangeCount() const
+{
+	unsigned int count = 0;
+	for (const Page& page : m_Pages)
+		count += (unsigned int)page.Free.size();
+	return count;
+}
+
+bool BufferArena::AllocateFrom(Page& page, unsigned int size, unsigned int alignment, unsigned int& offset)
+{
+	//smallest free range first, alignment padding may push a candidate over
+	for (auto it = page.FreeBySize.lower_bound(size); it != page.FreeBySize.end(); ++it)
+	{
+		unsigned int blockOffset = it->second;
+		unsigned int blockSize = it->first;
+		unsigned int aligned = (blockOffset + alignment - 1) / alignment * alignment;
+		unsigned int padding = aligned - blockOffset;
+		if (padding + size > blockSize)
+			continue;
+
+		RemoveFree(page, page.Free.find(blockOffset));
+		if (padding)
+			AddFree(page, blockOffset, padding);
+		if (padding + size < blockSize)
+			AddFree(page, aligned + size, blockSize - padding - size);
+
+		page.Used += size;
+		offset = aligned;
+		return true;
+	}
+	return false;
+}
+
+void BufferArena::AddFree(Page& page, unsigned int offset, unsigned int size)
+{
+	page.Free[offset] = size;
+	page.FreeBySize.insert({ size, offset });
+}
+
+void BufferArena::RemoveFree(Page& page, std::map<unsigned int, unsigned int>::iterator it)
+{
+	auto range = page.FreeBySize.equal_range(it->second);
+	for (auto bySize = range.first; bySize != range.second; ++bySize)
+	{
+		if (bySize->second == it->first)
+		{
+			page.FreeBySize.erase(bySize);
+			break;
+		}
+	}
+	page.Free.erase(it);
+}
+
+unsigned int BufferArena::CreatePage(unsigned int size)
+{
+	Page page;
+	page.Size = size;
+	page.Used = 0;
+	GLCall(glGenBuffers(1, &page.RendererID));
+	GLState::BindArrayBuffer(page.RendererID);
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GetBufferUsageHint(m_Usage)));
+	AddFree(page, 0, size);
+
+	m_Pages.push_back(page);
+	return (unsigned int)m_Pages.size() - 1;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "BufferUpdate.h"
+
+//a sub-range of one of the arena's GL buffers, offsets and sizes in bytes
+struct BufferRange
+{
+	unsigned int Page;
+	unsigned int Offset;
+	unsigned int Size;
+};
+
+// Owns a few large GL buffers (pages) and hands out ranges of them, so many
+// small meshes live in one buffer object and can share a VAO. Each page keeps
+// its free ranges ordered by offset, freed ranges merge with free neighbours,
+// and allocation takes the smallest free range that fits.
+// A range never spans two pages; requests bigger than the page size get a
+// page of their own. The arena must outlive every buffer allocated from it.
+class BufferArena
+{
+private:
+	struct Page
+	{
+		unsigned int RendererID;
+		unsigned int Size;
+		unsigned int Used;
+		//offset -> size, for coalescing
+		std::map<unsigned int, unsigned int> Free;
+		//size -> offset, for best fit
+		std::multimap<unsigned int, unsigned int> FreeBySize;
+	};
+
+	unsigned int m_PageSize;
+	BufferUsage m_Usage;
+	std::vector<Page> m_Pages;
+
+public:
+	//usage is the glBufferData hint for every page
+	BufferArena(unsigned int pageSize = 16 * 1024 * 1024, BufferUsage usage = BufferUsage::Static);
+	~BufferArena();
+
+	BufferArena(const BufferArena&) = delete;
+	BufferArena& operator=(const BufferArena&) = delete;
+
+	//offset is a multiple of alignment, pass the vertex stride so it converts to a base vertex
+	BufferRange Allocate(unsigned int size, unsigned int alignment);
+	void Free(const BufferRange& range);
+	//writes size bytes at offset into range, Orphan only orphans when range covers its whole page
+	void Upload(const BufferRange& range, unsigned int offset, const void* data, unsigned int size,
+		BufferUpdateStrategy strategy = BufferUpdateStrategy::SubData);
+
+	inline unsigned int GetRendererID(unsigned int page) const { return m_Pages[page].RendererID; }
+	inline unsigned int GetPageSize(unsigned int page) const { return m_Pages[page].Size; }
+	inline BufferUsage GetUsage() const { return m_Usage; }
+	inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+	unsigned int GetUsedSize() const;
+	unsigned int GetFreeRangeCount() const;
+
+private:
+	bool AllocateFrom(Page& page, unsigned int size, unsigned int alignment, unsigned int& offset);
+	void AddFree(Page& page, unsigned int offset, unsigned int size);
+	void RemoveFree(Page& page, std::map<unsigned int, unsigned int>::iterator it);
+	unsigned int CreatePage(unsigned int size);
+};
@@ -0,0 +1,70 @@
+#include "BufferUpdate.h"
+#include "Render.h"
+#include "GLState.h"
+
+#include <cstring>
+
+unsigned int GetBufferUsageHint(BufferUsage usage)
+{
+	switch (usage)
+	{
+	case BufferUsage::Dynamic: return GL_DYNAMIC_DRAW;
+	case BufferUsage::Stream:  return GL_STREAM_DRAW;
+	default:                   return GL_STATIC_DRAW;
+	}
+}
+
+BufferUpdateStrategy GetDefaultUpdateStrategy(BufferUsage usage)
+{
+	return usage == BufferUsage::Stream ? BufferUpdateStrategy::Orphan : BufferUpdateStrategy::SubData;
+}
+
+const char* GetBufferUpdateStrategyName(BufferUpdateStrategy strategy)
+{
+	switch (strategy)
+	{
+	case BufferUpdateStrategy::Orphan:            return "orphan";
+	case BufferUpdateStrategy::MapInvalidate:     return "map_invalidate";
+	case BufferUpdateStrategy::MapUnsynchronized: return "map_unsync";
+	default:                                      return "subdata";
+	}
+}
+
+void UpdateBuffer(unsigned int buffer, unsigned int capacity, unsigned int offset, const void* data, unsigned int size,
+	BufferUsage usage, BufferUpdateStrategy strategy)
+{
+	if (size == 0)
+		return;
+
+	GLState::BindArrayBuffer(buffer);
+
+	bool whole = offset == 0 && size == capacity;
+	if (strategy == BufferUpdateStrategy::Orphan && !whole)
+		strategy = BufferUpdateStrategy::MapInvalidate;
+
+	switch (strategy)
+	{
+	case BufferUpdateStrategy::Orphan:
+		//same size and hint as before, drivers recognize this and skip the wait
+		GLCall(glBufferData(GL_ARRAY_BUFFER, capacity, data, GetBufferUsageHint(usage)));
+		break;
+	case BufferUpdateStrategy::MapInvalidate:
+	case BufferUpdateStrategy::MapUnsynchronized:
+	{
+		GLbitfield access = GL_MAP_WRITE_BIT | (whole ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_INVALIDATE_RANGE_BIT);
+		if (strategy == BufferUpdateStrategy::MapUnsynchronized)
+			access |= GL_MAP_UNSYNCHRONIZED_BIT;
+		void* mapped;
+		GLCall(mapped = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, access));
+		if (mapped)
+		{
+			memcpy(mapped, data, size);
+			GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+		}
+		break;
+	}
+	default:
+		GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+		break;
+	}
+}
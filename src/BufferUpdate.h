@@ -0,0 +1,37 @@
+#pragma once
+
+//how often the contents change, picks the glBufferData usage hint
+enum class BufferUsage
+{
+	//written once, GL_STATIC_DRAW
+	Static,
+	//rewritten now and then, used for several draws, GL_DYNAMIC_DRAW
+	Dynamic,
+	//rewritten every frame and drawn a few times, GL_STREAM_DRAW
+	Stream
+};
+
+//how Update()/UpdateRange() get new contents into a buffer that the GPU may still be reading
+enum class BufferUpdateStrategy
+{
+	//glBufferSubData, the driver copies and synchronizes
+	SubData,
+	//glBufferData on the whole buffer so the driver can hand out fresh storage,
+	//ranges smaller than the buffer fall back to MapInvalidate
+	Orphan,
+	//glMapBufferRange with INVALIDATE_RANGE, the old contents of the range are discarded
+	MapInvalidate,
+	//glMapBufferRange with INVALIDATE_RANGE|UNSYNCHRONIZED, the caller makes sure the GPU is done
+	//with the range (fences, or ranges no pending draw reads)
+	MapUnsynchronized
+};
+
+unsigned int GetBufferUsageHint(BufferUsage usage);
+//Orphan for BufferUsage::Stream, SubData otherwise
+BufferUpdateStrategy GetDefaultUpdateStrategy(BufferUsage usage);
+const char* GetBufferUpdateStrategyName(BufferUpdateStrategy strategy);
+
+//writes size bytes at offset of a buffer holding capacity bytes, goes through GL_ARRAY_BUFFER
+//so that updating an index buffer leaves the bound VAO alone
+void UpdateBuffer(unsigned int buffer, unsigned int capacity, unsigned int offset, const void* data, unsigned int size,
+	BufferUsage usage, BufferUpdateStrategy strategy);
@@ -0,0 +1,171 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+static std::string GetDirectory(const std::string& filePath)
+{
+	size_t slash = filePath.find_last_of("/\\");
+	return slash == std::string::npos ? std::string() : filePath.substr(0, slash + 1);
+}
+#endif
+
+FileWatcher::FileWatcher()
+	:m_Running(true)
+{
+#ifdef __linux__
+	m_Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_Inotify < 0)
+		std::cout << "[FileWatcher] inotify_init1 failed, nothing will be watched" << std::endl;
+#endif
+	m_Thread = std::thread(&FileWatcher::Run, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+	m_Running = false;
+	m_Thread.join();
+#ifdef __linux__
+	if (m_Inotify >= 0)
+		close(m_Inotify);
+#endif
+}
+
+void FileWatcher::Watch(const std::string& filePath)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (!m_Files.insert(filePath).second)
+		return;
+
+#ifdef __linux__
+	if (m_Inotify < 0)
+		return;
+	std::string directory = GetDirectory(filePath);
+	for (const auto& entry : m_Directories)
+	{
+		if (entry.second == directory)
+			return;
+	}
+	int wd = inotify_add_watch(m_Inotify, directory.empty() ? "." : directory.c_str(),
+		IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (wd < 0)
+		std::cout << "[FileWatcher] cannot watch " << directory << std::endl;
+	else
+		m_Directories[wd] = directory;
+#else
+	m_Stamps[filePath] = GetStamp(filePath);
+#endif
+}
+
+std::vector<std::string> FileWatcher::TakeChanges()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	std::vector<std::string> changes;
+	changes.swap(m_Changes);
+	return changes;
+}
+
+void FileWatcher::AddChange(const std::string& filePath)
+{
+	//callers hold m_Mutex
+	if (std::find(m_Changes.begin(), m_Changes.end(), filePath) == m_Changes.end())
+		m_Changes.push_back(filePath);
+}
+
+#ifdef __linux__
+
+void FileWatcher::Run()
+{
+	//event records are variable length, the buffer must be aligned for inotify_event
+	alignas(inotify_event) char buffer[4096];
+	while (m_Running)
+	{
+		//the timeout only bounds how long the destructor waits for us
+		pollfd fd = { m_Inotify, POLLIN, 0 };
+		if (m_Inotify < 0 || poll(&fd, 1, 100) <= 0)
+		{
+			if (m_Inotify < 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			continue;
+		}
+
+		ssize_t length;
+		while ((length = read(m_Inotify, buffer, sizeof(buffer))) > 0)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			for (char* p = buffer; p < buffer + length; )
+			{
+				const inotify_event* event = (const inotify_event*)p;
+				p += sizeof(inotify_event) + event->len;
+
+				auto directory = m_Directories.find(event->wd);
+				if (event->len == 0 || directory == m_Directories.end())
+					continue;
+				std::string filePath = directory->second + event->name;
+				if (m_Files.count(filePath))
+					AddChange(filePath);
+			}
+		}
+	}
+}
+
+#else
+
+FileWatcher::FileStamp FileWatcher::GetStamp(const std::string& filePath)
+{
+	//a missing file reads as { 0, -1 }, so it counts as changed once it appears
+	FileStamp stamp = { 0, -1 };
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (GetFileAttributesExA(filePath.c_str(), GetFileExInfoStandard, &data))
+	{
+		stamp.Time = ((long long)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+		stamp.Size = ((long long)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+	}
+#else
+	struct stat info;
+	if (stat(filePath.c_str(), &info) == 0)
+	{
+		stamp.Time = (long long)info.st_mtime;
+		stamp.Size = (long long)info.st_size;
+	}
+#endif
+	return stamp;
+}
+
+void FileWatcher::Run()
+{
+	while (m_Running)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (auto& entry : m_Stamps)
+		{
+			//the size catches a second save within the same mtime second where only stat is available
+			FileStamp stamp = GetStamp(entry.first);
+			if (stamp.Size < 0)
+				continue;
+			if (stamp.Time != entry.second.Time || stamp.Size != entry.second.Size)
+			{
+				entry.second = stamp;
+				AddChange(entry.first);
+			}
+		}
+	}
+}
+
+#endif
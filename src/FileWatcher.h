@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+
+// Watches files from a background thread and queues the ones that changed.
+// On Linux it sleeps on inotify, watching the directories rather than the
+// files, since editors tend to save by writing a new file and renaming it over
+// the old one. Elsewhere it falls back to comparing modification times and
+// sizes a few times a second. Paths are reported exactly as they were passed
+// to Watch().
+class FileWatcher
+{
+private:
+	std::thread m_Thread;
+	std::atomic<bool> m_Running;
+	std::mutex m_Mutex;
+	std::unordered_set<std::string> m_Files;
+	std::vector<std::string> m_Changes;
+#ifdef __linux__
+	int m_Inotify;
+	//watch descriptor -> directory prefix, as it appears in the watched paths
+	std::unordered_map<int, std::string> m_Directories;
+#else
+	struct FileStamp
+	{
+		//FILETIME (100ns steps) on Windows, whole seconds from stat elsewhere
+		long long Time;
+		long long Size;
+	};
+	std::unordered_map<std::string, FileStamp> m_Stamps;
+
+	static FileStamp GetStamp(const std::string& filePath);
+#endif
+
+public:
+	FileWatcher();
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	//watching a file twice is fine
+	void Watch(const std::string& filePath);
+	//files changed since the last call, each listed once
+	std::vector<std::string> TakeChanges();
+
+private:
+	void Run();
+	void AddChange(const std::string& filePath);
+};
@@ -0,0 +1,53 @@
+#include "FrameStats.h"
+#include "Render.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+void FrameStats::AddFrame(double ms, const RenderStats& stats)
+{
+	m_FrameMs.push_back(ms);
+	m_Draws += stats.Draws;
+	m_Triangles += stats.Triangles;
+}
+
+double FrameStats::Percentile(double p) const
+{
+	if (m_FrameMs.empty())
+		return 0.0;
+
+	std::vector<double> sorted(m_FrameMs);
+	std::sort(sorted.begin(), sorted.end());
+	//smallest value with at least p percent of the frames at or below it
+	size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+	rank = std::max<size_t>(1, std::min(rank, sorted.size()));
+	return sorted[rank - 1];
+}
+
+double FrameStats::GetTotalMs() const
+{
+	double total = 0.0;
+	for (double ms : m_FrameMs)
+		total += ms;
+	return total;
+}
+
+std::string FrameStats::ToJson(const std::string& name) const
+{
+	double seconds = GetTotalMs() / 1000.0;
+	double frames = (double)m_FrameMs.size();
+
+	std::stringstream ss;
+	ss << "{\"name\":\"" << name << "\""
+		<< ",\"frames\":" << m_FrameMs.size()
+		<< ",\"mean_ms\":" << (frames > 0 ? GetTotalMs() / frames : 0.0)
+		<< ",\"p50_ms\":" << Percentile(50.0)
+		<< ",\"p90_ms\":" << Percentile(90.0)
+		<< ",\"p99_ms\":" << Percentile(99.0)
+		<< ",\"max_ms\":" << Percentile(100.0)
+		<< ",\"draws_per_sec\":" << (seconds > 0 ? m_Draws / seconds : 0.0)
+		<< ",\"triangles_per_sec\":" << (seconds > 0 ? m_Triangles / seconds : 0.0)
+		<< "}";
+	return ss.str();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct RenderStats;
+
+//collects per-frame timings of a benchmark run and summarizes them
+class FrameStats
+{
+private:
+	std::vector<double> m_FrameMs;
+	unsigned long long m_Draws;
+	unsigned long long m_Triangles;
+
+public:
+	FrameStats()
+		:m_Draws(0), m_Triangles(0) {}
+
+	void Reserve(unsigned int frames) { m_FrameMs.reserve(frames); }
+	void AddFrame(double ms, const RenderStats& stats);
+
+	//p in [0, 100], nearest-rank on the sorted frame times
+	double Percentile(double p) const;
+	double GetTotalMs() const;
+	inline unsigned int GetFrameCount() const { return (unsigned int)m_FrameMs.size(); }
+
+	//one line of JSON with frame time percentiles and throughput
+	std::string ToJson(const std::string& name) const;
+};
@@ -0,0 +1,48 @@
+#include "Framebuffer.h"
+#include "Render.h"
+#include "GLState.h"
+
+Framebuffer::Framebuffer(unsigned int width, unsigned int height)
+	:m_Width(width), m_Height(height)
+{
+	GLCall(glGenFramebuffers(1, &m_RendererID));
+	GLState::BindFramebuffer(m_RendererID);
+
+	GLCall(glGenRenderbuffers(1, &m_ColorAttachment));
+	GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_ColorAttachment));
+	GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+	GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorAttachment));
+
+	GLCall(glGenRenderbuffers(1, &m_DepthAttachment));
+	GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment));
+	GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height));
+	GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthAttachment));
+
+	GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+}
+
+Framebuffer::~Framebuffer()
+{
+	GLState::OnDeleteFramebuffer(m_RendererID);
+	GLCall(glDeleteFramebuffers(1, &m_RendererID));
+	GLCall(glDeleteRenderbuffers(1, &m_ColorAttachment));
+	GLCall(glDeleteRenderbuffers(1, &m_DepthAttachment));
+}
+
+void Framebuffer::Bind() const
+{
+	GLState::BindFramebuffer(m_RendererID);
+	GLCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void Framebuffer::UnBind() const
+{
+	GLState::BindFramebuffer(0);
+}
+
+bool Framebuffer::IsComplete() const
+{
+	Bind();
+	GLCall(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	return status == GL_FRAMEBUFFER_COMPLETE;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+//offscreen render target with a color and a depth/stencil renderbuffer
+class Framebuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorAttachment;
+	unsigned int m_DepthAttachment;
+	unsigned int m_Width;
+	unsigned int m_Height;
+
+public:
+	Framebuffer(unsigned int width, unsigned int height);
+	~Framebuffer();
+
+	//also sets the viewport to the framebuffer size
+	void Bind() const;
+	void UnBind() const;
+
+	bool IsComplete() const;
+
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+};
@@ -0,0 +1,114 @@
+#include "GLDebug.h"
+#include "Render.h"
+#include "GLExtensions.h"
+
+#include <iostream>
+
+GLDebugMode GLDebug::s_Mode = (GLDebugMode)GLCALL_MODE;
+const char* GLDebug::s_Function = "";
+const char* GLDebug::s_File = "";
+int GLDebug::s_Line = 0;
+unsigned long long GLDebug::s_CallCount = 0;
+
+std::mutex GLDebug::s_Lock;
+std::vector<GLDebugMessage> GLDebug::s_Pending;
+unsigned int GLDebug::s_Dropped = 0;
+
+static void APIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+	GLsizei length, const GLchar* message, const void* userParam)
+{
+	//performance hints and notifications would drown the real errors
+	if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+		return;
+
+	GLDebug::Report({ source, type, id, severity, std::string(message, length),
+		GLDebug::GetLastFunction(), GLDebug::GetLastFile(), GLDebug::GetLastLine() });
+}
+
+void GLDebug::Init()
+{
+	if (s_Mode == GLDebugMode::Off)
+		return;
+
+	if (s_Mode == GLDebugMode::Callback && !GLExtensions::HasDebugOutput())
+	{
+		std::cerr << "[OpenGL] KHR_debug/ARB_debug_output not available, GLCall falls back to glGetError" << std::endl;
+		s_Mode = GLDebugMode::Sync;
+	}
+	SetMode(s_Mode);
+}
+
+void GLDebug::SetMode(GLDebugMode mode)
+{
+	//the GLCall sites were compiled out, there is nothing to switch
+	if (GLCALL_MODE == GLCALL_MODE_OFF)
+		return;
+
+	if (mode == GLDebugMode::Callback && !GLExtensions::HasDebugOutput())
+		mode = GLDebugMode::Sync;
+	s_Mode = mode;
+
+	if (!GLExtensions::HasDebugOutput())
+		return;
+
+	//the driver reports from inside the failing call, without a glGetError round-trip per call;
+	//synchronous output keeps the callback on this thread, so the GLCall site it reads is the
+	//current one and s_Function/s_File/s_Line need no locking
+	if (mode == GLDebugMode::Callback)
+	{
+		GLExtensions::DebugMessageCallback(DebugMessageCallback, nullptr);
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		if (GLExtensions::HasDebugOutputToggle())
+			glEnable(GL_DEBUG_OUTPUT);
+	}
+	else
+	{
+		if (GLExtensions::HasDebugOutputToggle())
+			glDisable(GL_DEBUG_OUTPUT);
+		glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		GLExtensions::DebugMessageCallback(nullptr, nullptr);
+	}
+}
+
+void GLDebug::Report(const GLDebugMessage& message)
+{
+	std::lock_guard<std::mutex> lock(s_Lock);
+	if (s_Pending.size() >= MaxPendingMessages)
+	{
+		s_Dropped++;
+		return;
+	}
+	s_Pending.push_back(message);
+}
+
+void GLDebug::FlushMessages()
+{
+	std::vector<GLDebugMessage> messages;
+	unsigned int dropped;
+	{
+		std::lock_guard<std::mutex> lock(s_Lock);
+		if (s_Pending.empty() && s_Dropped == 0)
+			return;
+		messages.swap(s_Pending);
+		dropped = s_Dropped;
+		s_Dropped = 0;
+	}
+
+	for (const GLDebugMessage& message : messages)
+	{
+		std::cerr << "[OpenGL Error] (" << message.ID << ") " << message.Text
+			<< " near " << message.Function << " " << message.File << ": " << message.Line << std::endl;
+	}
+	if (dropped)
+		std::cerr << "[OpenGL Error] " << dropped << " more messages dropped" << std::endl;
+}
+
+void GLDebug::ClearErrors()
+{
+	GLClearError();
+}
+
+bool GLDebug::CheckErrors()
+{
+	return GLLogCall(s_Function, s_File, s_Line);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+// How GLCall checks for errors:
+//  OFF      - GLCall(x) is just x, nothing is checked
+//  CALLBACK - GL_KHR_debug (or ARB_debug_output) reports errors through a
+//             callback, GLCall only records its call site so the report can
+//             name it. Requires GL_DEBUG_OUTPUT_SYNCHRONOUS, which SetMode
+//             enables: the call site is unsynchronized and only valid when
+//             the callback runs on the thread that made the call
+//  SYNC     - glGetError around every call, breaks on the offending line
+// Builds pick the mode with GLCALL_MODE; when it is not OFF the runtime mode
+// can still be switched between CALLBACK and SYNC with GLDebug::SetMode.
+// Every GLCall is counted unless the mode is OFF; define GLCALL_COUNT to keep
+// counting in OFF builds too (the benchmarks report GL calls per draw).
+#define GLCALL_MODE_OFF 0
+#define GLCALL_MODE_CALLBACK 1
+#define GLCALL_MODE_SYNC 2
+
+#ifndef GLCALL_MODE
+#ifdef _DEBUG
+#define GLCALL_MODE GLCALL_MODE_SYNC
+#else
+#define GLCALL_MODE GLCALL_MODE_OFF
+#endif
+#endif
+
+enum class GLDebugMode
+{
+	Off = GLCALL_MODE_OFF, Callback = GLCALL_MODE_CALLBACK, Sync = GLCALL_MODE_SYNC
+};
+
+struct GLDebugMessage
+{
+	unsigned int Source;
+	unsigned int Type;
+	unsigned int ID;
+	unsigned int Severity;
+	std::string Text;
+	//GLCall site that raised the message
+	const char* Function;
+	const char* File;
+	int Line;
+};
+
+class GLDebug
+{
+public:
+	static const unsigned int MaxPendingMessages = 256;
+
+	//after GLExtensions::Load; installs the debug callback when asked for,
+	//and drops back to Sync if the context does not support it
+	static void Init();
+	static void SetMode(GLDebugMode mode);
+	static inline GLDebugMode GetMode() { return s_Mode; }
+
+	static inline void BeginCall(const char* function, const char* file, int line)
+	{
+		s_CallCount++;
+		s_Function = function;
+		s_File = file;
+		s_Line = line;
+		if (s_Mode == GLDebugMode::Sync)
+			ClearErrors();
+	}
+
+	static inline bool EndCall()
+	{
+		return s_Mode != GLDebugMode::Sync || CheckErrors();
+	}
+
+	static inline void CountCall() { s_CallCount++; }
+	static inline unsigned long long GetCallCount() { return s_CallCount; }
+	static inline bool IsCountingCalls()
+	{
+#if GLCALL_MODE != GLCALL_MODE_OFF || defined(GLCALL_COUNT)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	static inline const char* GetLastFunction() { return s_Function; }
+	static inline const char* GetLastFile() { return s_File; }
+	static inline int GetLastLine() { return s_Line; }
+
+	//queues a report, never blocks on output; safe from the driver's callback thread
+	static void Report(const GLDebugMessage& message);
+	//writes queued reports to stderr, call once per frame from the main thread
+	static void FlushMessages();
+
+private:
+	static void ClearErrors();
+	static bool CheckErrors();
+
+	static GLDebugMode s_Mode;
+	static const char* s_Function;
+	static const char* s_File;
+	static int s_Line;
+	static unsigned long long s_CallCount;
+
+	static std::mutex s_Lock;
+	static std::vector<GLDebugMessage> s_Pending;
+	static unsigned int s_Dropped;
+};
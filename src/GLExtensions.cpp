@@ -0,0 +1,141 @@
+#include "GLExtensions.h"
+#include "Render.h"
+
+#include <cstring>
+
+PFNGLGETPROGRAMBINARYPROC GLExtensions::GetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC GLExtensions::ProgramBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC GLExtensions::ProgramParameteri = nullptr;
+PFNGLGENPROGRAMPIPELINESPROC GLExtensions::GenProgramPipelines = nullptr;
+PFNGLDELETEPROGRAMPIPELINESPROC GLExtensions::DeleteProgramPipelines = nullptr;
+PFNGLBINDPROGRAMPIPELINEPROC GLExtensions::BindProgramPipeline = nullptr;
+PFNGLUSEPROGRAMSTAGESPROC GLExtensions::UseProgramStages = nullptr;
+PFNGLVALIDATEPROGRAMPIPELINEPROC GLExtensions::ValidateProgramPipeline = nullptr;
+PFNGLGETPROGRAMPIPELINEIVPROC GLExtensions::GetProgramPipelineiv = nullptr;
+PFNGLGETPROGRAMPIPELINEINFOLOGPROC GLExtensions::GetProgramPipelineInfoLog = nullptr;
+PFNGLPROGRAMUNIFORM1FVPROC GLExtensions::ProgramUniform1fv = nullptr;
+PFNGLPROGRAMUNIFORM2FVPROC GLExtensions::ProgramUniform2fv = nullptr;
+PFNGLPROGRAMUNIFORM3FVPROC GLExtensions::ProgramUniform3fv = nullptr;
+PFNGLPROGRAMUNIFORM4FVPROC GLExtensions::ProgramUniform4fv = nullptr;
+PFNGLPROGRAMUNIFORM1IVPROC GLExtensions::ProgramUniform1iv = nullptr;
+PFNGLPROGRAMUNIFORM2IVPROC GLExtensions::ProgramUniform2iv = nullptr;
+PFNGLPROGRAMUNIFORM3IVPROC GLExtensions::ProgramUniform3iv = nullptr;
+PFNGLPROGRAMUNIFORM4IVPROC GLExtensions::ProgramUniform4iv = nullptr;
+PFNGLPROGRAMUNIFORM1UIVPROC GLExtensions::ProgramUniform1uiv = nullptr;
+PFNGLPROGRAMUNIFORM2UIVPROC GLExtensions::ProgramUniform2uiv = nullptr;
+PFNGLPROGRAMUNIFORM3UIVPROC GLExtensions::ProgramUniform3uiv = nullptr;
+PFNGLPROGRAMUNIFORM4UIVPROC GLExtensions::ProgramUniform4uiv = nullptr;
+PFNGLPROGRAMUNIFORMMATRIX2FVPROC GLExtensions::ProgramUniformMatrix2fv = nullptr;
+PFNGLPROGRAMUNIFORMMATRIX3FVPROC GLExtensions::ProgramUniformMatrix3fv = nullptr;
+PFNGLPROGRAMUNIFORMMATRIX4FVPROC GLExtensions::ProgramUniformMatrix4fv = nullptr;
+PFNGLSHADERBINARYPROC GLExtensions::ShaderBinary = nullptr;
+PFNGLSPECIALIZESHADERPROC GLExtensions::SpecializeShader = nullptr;
+PFNGLBUFFERSTORAGEPROC GLExtensions::BufferStorage = nullptr;
+PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC GLExtensions::DrawElementsInstancedBaseVertexBaseInstance = nullptr;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC GLExtensions::MultiDrawElementsIndirect = nullptr;
+PFNGLDEBUGMESSAGECALLBACKPROC GLExtensions::DebugMessageCallback = nullptr;
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC GLExtensions::MaxShaderCompilerThreads = nullptr;
+
+int GLExtensions::s_Major = 0;
+int GLExtensions::s_Minor = 0;
+bool GLExtensions::s_DebugOutputToggle = false;
+
+void GLExtensions::Load(GLADloadproc load)
+{
+	GLCall(glGetIntegerv(GL_MAJOR_VERSION, &s_Major));
+	GLCall(glGetIntegerv(GL_MINOR_VERSION, &s_Minor));
+
+	//a driver may export an entry point it does not actually support,
+	//so only take the pointer when the version or extension says so
+	if (IsVersion(4, 1) || IsSupported("GL_ARB_get_program_binary"))
+	{
+		GetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+		ProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+		ProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+	}
+
+	if (IsVersion(4, 1) || IsSupported("GL_ARB_separate_shader_objects"))
+	{
+		//glProgramParameteri is part of both extensions
+		ProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+		GenProgramPipelines = (PFNGLGENPROGRAMPIPELINESPROC)load("glGenProgramPipelines");
+		DeleteProgramPipelines = (PFNGLDELETEPROGRAMPIPELINESPROC)load("glDeleteProgramPipelines");
+		BindProgramPipeline = (PFNGLBINDPROGRAMPIPELINEPROC)load("glBindProgramPipeline");
+		UseProgramStages = (PFNGLUSEPROGRAMSTAGESPROC)load("glUseProgramStages");
+		ValidateProgramPipeline = (PFNGLVALIDATEPROGRAMPIPELINEPROC)load("glValidateProgramPipeline");
+		GetProgramPipelineiv = (PFNGLGETPROGRAMPIPELINEIVPROC)load("glGetProgramPipelineiv");
+		GetProgramPipelineInfoLog = (PFNGLGETPROGRAMPIPELINEINFOLOGPROC)load("glGetProgramPipelineInfoLog");
+		ProgramUniform1fv = (PFNGLPROGRAMUNIFORM1FVPROC)load("glProgramUniform1fv");
+		ProgramUniform2fv = (PFNGLPROGRAMUNIFORM2FVPROC)load("glProgramUniform2fv");
+		ProgramUniform3fv = (PFNGLPROGRAMUNIFORM3FVPROC)load("glProgramUniform3fv");
+		ProgramUniform4fv = (PFNGLPROGRAMUNIFORM4FVPROC)load("glProgramUniform4fv");
+		ProgramUniform1iv = (PFNGLPROGRAMUNIFORM1IVPROC)load("glProgramUniform1iv");
+		ProgramUniform2iv = (PFNGLPROGRAMUNIFORM2IVPROC)load("glProgramUniform2iv");
+		ProgramUniform3iv = (PFNGLPROGRAMUNIFORM3IVPROC)load("glProgramUniform3iv");
+		ProgramUniform4iv = (PFNGLPROGRAMUNIFORM4IVPROC)load("glProgramUniform4iv");
+		ProgramUniform1uiv = (PFNGLPROGRAMUNIFORM1UIVPROC)load("glProgramUniform1uiv");
+		ProgramUniform2uiv = (PFNGLPROGRAMUNIFORM2UIVPROC)load("glProgramUniform2uiv");
+		ProgramUniform3uiv = (PFNGLPROGRAMUNIFORM3UIVPROC)load("glProgramUniform3uiv");
+		ProgramUniform4uiv = (PFNGLPROGRAMUNIFORM4UIVPROC)load("glProgramUniform4uiv");
+		ProgramUniformMatrix2fv = (PFNGLPROGRAMUNIFORMMATRIX2FVPROC)load("glProgramUniformMatrix2fv");
+		ProgramUniformMatrix3fv = (PFNGLPROGRAMUNIFORMMATRIX3FVPROC)load("glProgramUniformMatrix3fv");
+		ProgramUniformMatrix4fv = (PFNGLPROGRAMUNIFORMMATRIX4FVPROC)load("glProgramUniformMatrix4fv");
+	}
+
+	//ARB_gl_spirv needs GL 4.5, glShaderBinary is core since 4.1
+	if (IsVersion(4, 6))
+		SpecializeShader = (PFNGLSPECIALIZESHADERPROC)load("glSpecializeShader");
+	else if (IsVersion(4, 5) && IsSupported("GL_ARB_gl_spirv"))
+		SpecializeShader = (PFNGLSPECIALIZESHADERPROC)load("glSpecializeShaderARB");
+	if (SpecializeShader)
+		ShaderBinary = (PFNGLSHADERBINARYPROC)load("glShaderBinary");
+
+	if (IsVersion(4, 4) || IsSupported("GL_ARB_buffer_storage"))
+		BufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+
+	if (IsVersion(4, 2) || IsSupported("GL_ARB_base_instance"))
+		DrawElementsInstancedBaseVertexBaseInstance = (PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC)
+			load("glDrawElementsInstancedBaseVertexBaseInstance");
+
+	if (IsVersion(4, 3) || IsSupported("GL_ARB_multi_draw_indirect"))
+		MultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+
+	if (IsSupported("GL_KHR_parallel_shader_compile"))
+		MaxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+	else if (IsSupported("GL_ARB_parallel_shader_compile"))
+		MaxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+	//0xFFFFFFFF lets the driver pick how many compiler threads to use
+	if (MaxShaderCompilerThreads)
+	{
+		GLCall(MaxShaderCompilerThreads(0xFFFFFFFF));
+	}
+
+	//desktop KHR_debug has no suffix, the KHR names only exist on GLES
+	if (IsVersion(4, 3) || IsSupported("GL_KHR_debug"))
+	{
+		DebugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKPROC)load("glDebugMessageCallback");
+		s_DebugOutputToggle = DebugMessageCallback != nullptr;
+	}
+	else if (IsSupported("GL_ARB_debug_output"))
+	{
+		DebugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKPROC)load("glDebugMessageCallbackARB");
+	}
+}
+
+bool GLExtensions::IsSupported(const char* extension)
+{
+	int count = 0;
+	GLCall(glGetIntegerv(GL_NUM_EXTENSIONS, &count));
+	for (int i = 0; i < count; i++)
+	{
+		const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (name && strcmp(name, extension) == 0)
+			return true;
+	}
+	return false;
+}
+
+bool GLExtensions::IsVersion(int major, int minor)
+{
+	return s_Major > major || (s_Major == major && s_Minor >= minor);
+}
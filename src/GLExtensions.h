@@ -0,0 +1,171 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// glad was generated for the GL 3.3 core profile only. Anything newer is
+// declared here and loaded at runtime by GLExtensions::Load(), so every
+// feature built on top of it needs a 3.3 fallback path.
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+#ifndef GL_DEBUG_OUTPUT
+#define GL_DEBUG_OUTPUT 0x92E0
+#define GL_DEBUG_TYPE_ERROR 0x824C
+#define GL_DEBUG_SEVERITY_HIGH 0x9146
+#define GL_DEBUG_SEVERITY_NOTIFICATION 0x826B
+#endif
+
+#ifndef GL_DEBUG_OUTPUT_SYNCHRONOUS
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS 0x8242
+#endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+#ifndef GL_COMPUTE_SHADER
+#define GL_TESS_EVALUATION_SHADER 0x8E87
+#define GL_TESS_CONTROL_SHADER 0x8E88
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+
+#ifndef GL_PROGRAM_SEPARABLE
+#define GL_PROGRAM_SEPARABLE 0x8258
+#define GL_PROGRAM_PIPELINE_BINDING 0x825A
+#define GL_VERTEX_SHADER_BIT 0x00000001
+#define GL_FRAGMENT_SHADER_BIT 0x00000002
+#define GL_GEOMETRY_SHADER_BIT 0x00000004
+#define GL_TESS_CONTROL_SHADER_BIT 0x00000008
+#define GL_TESS_EVALUATION_SHADER_BIT 0x00000010
+#define GL_COMPUTE_SHADER_BIT 0x00000020
+#endif
+
+#ifndef GL_SHADER_BINARY_FORMAT_SPIR_V
+#define GL_SHADER_BINARY_FORMAT_SPIR_V 0x9551
+#endif
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+//GL 4.1 / ARB_get_program_binary
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei* length,
+	GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+//GL 4.1 / ARB_separate_shader_objects
+typedef void (APIENTRYP PFNGLGENPROGRAMPIPELINESPROC)(GLsizei n, GLuint* pipelines);
+typedef void (APIENTRYP PFNGLDELETEPROGRAMPIPELINESPROC)(GLsizei n, const GLuint* pipelines);
+typedef void (APIENTRYP PFNGLBINDPROGRAMPIPELINEPROC)(GLuint pipeline);
+typedef void (APIENTRYP PFNGLUSEPROGRAMSTAGESPROC)(GLuint pipeline, GLbitfield stages, GLuint program);
+typedef void (APIENTRYP PFNGLVALIDATEPROGRAMPIPELINEPROC)(GLuint pipeline);
+typedef void (APIENTRYP PFNGLGETPROGRAMPIPELINEIVPROC)(GLuint pipeline, GLenum pname, GLint* params);
+typedef void (APIENTRYP PFNGLGETPROGRAMPIPELINEINFOLOGPROC)(GLuint pipeline, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM1FVPROC)(GLuint program, GLint location, GLsizei count, const GLfloat* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM2FVPROC)(GLuint program, GLint location, GLsizei count, const GLfloat* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM3FVPROC)(GLuint program, GLint location, GLsizei count, const GLfloat* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM4FVPROC)(GLuint program, GLint location, GLsizei count, const GLfloat* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM1IVPROC)(GLuint program, GLint location, GLsizei count, const GLint* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM2IVPROC)(GLuint program, GLint location, GLsizei count, const GLint* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM3IVPROC)(GLuint program, GLint location, GLsizei count, const GLint* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM4IVPROC)(GLuint program, GLint location, GLsizei count, const GLint* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM1UIVPROC)(GLuint program, GLint location, GLsizei count, const GLuint* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM2UIVPROC)(GLuint program, GLint location, GLsizei count, const GLuint* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM3UIVPROC)(GLuint program, GLint location, GLsizei count, const GLuint* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM4UIVPROC)(GLuint program, GLint location, GLsizei count, const GLuint* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORMMATRIX2FVPROC)(GLuint program, GLint location, GLsizei count,
+	GLboolean transpose, const GLfloat* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORMMATRIX3FVPROC)(GLuint program, GLint location, GLsizei count,
+	GLboolean transpose, const GLfloat* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORMMATRIX4FVPROC)(GLuint program, GLint location, GLsizei count,
+	GLboolean transpose, const GLfloat* value);
+//GL 4.1 / ARB_ES2_compatibility
+typedef void (APIENTRYP PFNGLSHADERBINARYPROC)(GLsizei count, const GLuint* shaders, GLenum binaryformat,
+	const void* binary, GLsizei length);
+//GL 4.6 / ARB_gl_spirv
+typedef void (APIENTRYP PFNGLSPECIALIZESHADERPROC)(GLuint shader, const GLchar* pEntryPoint,
+	GLuint numSpecializationConstants, const GLuint* pConstantIndex, const GLuint* pConstantValue);
+//GL 4.4 / ARB_buffer_storage
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+//GL 4.2 / ARB_base_instance
+typedef void (APIENTRYP PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC)(GLenum mode, GLsizei count, GLenum type,
+	const void* indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance);
+//GL 4.3 / ARB_multi_draw_indirect
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect,
+	GLsizei drawcount, GLsizei stride);
+//KHR_parallel_shader_compile
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+//GL 4.3 / KHR_debug
+typedef void (APIENTRYP PFNGLDEBUGMESSAGECALLBACKPROC)(GLDEBUGPROC callback, const void* userParam);
+
+class GLExtensions
+{
+public:
+	static PFNGLGETPROGRAMBINARYPROC GetProgramBinary;
+	static PFNGLPROGRAMBINARYPROC ProgramBinary;
+	static PFNGLPROGRAMPARAMETERIPROC ProgramParameteri;
+	static PFNGLGENPROGRAMPIPELINESPROC GenProgramPipelines;
+	static PFNGLDELETEPROGRAMPIPELINESPROC DeleteProgramPipelines;
+	static PFNGLBINDPROGRAMPIPELINEPROC BindProgramPipeline;
+	static PFNGLUSEPROGRAMSTAGESPROC UseProgramStages;
+	static PFNGLVALIDATEPROGRAMPIPELINEPROC ValidateProgramPipeline;
+	static PFNGLGETPROGRAMPIPELINEIVPROC GetProgramPipelineiv;
+	static PFNGLGETPROGRAMPIPELINEINFOLOGPROC GetProgramPipelineInfoLog;
+	static PFNGLPROGRAMUNIFORM1FVPROC ProgramUniform1fv;
+	static PFNGLPROGRAMUNIFORM2FVPROC ProgramUniform2fv;
+	static PFNGLPROGRAMUNIFORM3FVPROC ProgramUniform3fv;
+	static PFNGLPROGRAMUNIFORM4FVPROC ProgramUniform4fv;
+	static PFNGLPROGRAMUNIFORM1IVPROC ProgramUniform1iv;
+	static PFNGLPROGRAMUNIFORM2IVPROC ProgramUniform2iv;
+	static PFNGLPROGRAMUNIFORM3IVPROC ProgramUniform3iv;
+	static PFNGLPROGRAMUNIFORM4IVPROC ProgramUniform4iv;
+	static PFNGLPROGRAMUNIFORM1UIVPROC ProgramUniform1uiv;
+	static PFNGLPROGRAMUNIFORM2UIVPROC ProgramUniform2uiv;
+	static PFNGLPROGRAMUNIFORM3UIVPROC ProgramUniform3uiv;
+	static PFNGLPROGRAMUNIFORM4UIVPROC ProgramUniform4uiv;
+	static PFNGLPROGRAMUNIFORMMATRIX2FVPROC ProgramUniformMatrix2fv;
+	static PFNGLPROGRAMUNIFORMMATRIX3FVPROC ProgramUniformMatrix3fv;
+	static PFNGLPROGRAMUNIFORMMATRIX4FVPROC ProgramUniformMatrix4fv;
+	static PFNGLSHADERBINARYPROC ShaderBinary;
+	static PFNGLSPECIALIZESHADERPROC SpecializeShader;
+	static PFNGLBUFFERSTORAGEPROC BufferStorage;
+	static PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC DrawElementsInstancedBaseVertexBaseInstance;
+	static PFNGLMULTIDRAWELEMENTSINDIRECTPROC MultiDrawElementsIndirect;
+	static PFNGLDEBUGMESSAGECALLBACKPROC DebugMessageCallback;
+	static PFNGLMAXSHADERCOMPILERTHREADSKHRPROC MaxShaderCompilerThreads;
+
+	//needs a current context, call right after gladLoadGLLoader
+	static void Load(GLADloadproc load);
+
+	static bool IsSupported(const char* extension);
+	static bool IsVersion(int major, int minor);
+
+	static inline bool HasProgramBinary() { return ProgramBinary != nullptr; }
+	static inline bool HasSeparateShaderObjects() { return UseProgramStages != nullptr; }
+	static inline bool HasSpirv() { return SpecializeShader != nullptr; }
+	static inline bool HasProgramUniform() { return ProgramUniform4fv != nullptr; }
+	static inline bool HasBufferStorage() { return BufferStorage != nullptr; }
+	static inline bool HasBaseInstance() { return DrawElementsInstancedBaseVertexBaseInstance != nullptr; }
+	static inline bool HasMultiDrawIndirect() { return MultiDrawElementsIndirect != nullptr; }
+	static inline bool HasParallelShaderCompile() { return MaxShaderCompilerThreads != nullptr; }
+	static inline bool HasDebugOutput() { return DebugMessageCallback != nullptr; }
+	//GL_DEBUG_OUTPUT is a KHR_debug capability, ARB_debug_output is always on in a debug context
+	static inline bool HasDebugOutputToggle() { return s_DebugOutputToggle; }
+
+	//forces the 3.3 fallback paths, e.g. to compare them against the native ones
+	static void DisableMultiDrawIndirect() { MultiDrawElementsIndirect = nullptr; }
+
+private:
+	static int s_Major;
+	static int s_Minor;
+	static bool s_DebugOutputToggle;
+};
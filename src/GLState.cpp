@@ -0,0 +1,295 @@
+#include "GLState.h"
+#include "Render.h"
+#include "GLExtensions.h"
+
+//value the shadow holds when the real GL state is unknown
+static const unsigned int Unknown = 0xFFFFFFFF;
+
+unsigned int GLState::s_Program = Unknown;
+unsigned int GLState::s_ProgramPipeline = Unknown;
+unsigned int GLState::s_VertexArray = Unknown;
+unsigned int GLState::s_ArrayBuffer = Unknown;
+unsigned int GLState::s_DrawIndirectBuffer = Unknown;
+unsigned int GLState::s_Framebuffer = Unknown;
+unsigned int GLState::s_ActiveTexture = Unknown;
+unsigned int GLState::s_TextureTargets[GLState::MaxTextureUnits];
+unsigned int GLState::s_Textures[GLState::MaxTextureUnits];
+unsigned int GLState::s_UniformBuffers[GLState::MaxUniformBufferBindings];
+unsigned int GLState::s_Blend = Unknown;
+unsigned int GLState::s_BlendSrc = Unknown;
+unsigned int GLState::s_BlendDst = Unknown;
+unsigned int GLState::s_DepthTest = Unknown;
+unsigned int GLState::s_DepthMask = Unknown;
+unsigned int GLState::s_PrimitiveRestart = Unknown;
+unsigned int GLState::s_PrimitiveRestartType = Unknown;
+std::unordered_map<unsigned int, unsigned int> GLState::s_ElementBuffers;
+
+GLStateStats GLState::s_Frame = { 0, 0 };
+GLStateStats GLState::s_LastFrame = { 0, 0 };
+
+bool GLState::Changed(unsigned int& shadow, unsigned int value)
+{
+	if (shadow == value)
+	{
+		s_Frame.SkippedBinds++;
+		return false;
+	}
+	shadow = value;
+	s_Frame.IssuedBinds++;
+	return true;
+}
+
+void GLState::BindProgram(unsigned int program)
+{
+	if (Changed(s_Program, program))
+	{
+		GLCall(glUseProgram(program));
+	}
+}
+
+void GLState::BindProgramPipeline(unsigned int pipeline)
+{
+	if (Changed(s_ProgramPipeline, pipeline))
+	{
+		GLCall(GLExtensions::BindProgramPipeline(pipeline));
+	}
+}
+
+void GLState::BindVertexArray(unsigned int vao)
+{
+	if (Changed(s_VertexArray, vao))
+	{
+		GLCall(glBindVertexArray(vao));
+	}
+}
+
+void GLState::BindArrayBuffer(unsigned int buffer)
+{
+	if (Changed(s_ArrayBuffer, buffer))
+	{
+		GLCall(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+	}
+}
+
+void GLState::BindElementBuffer(unsigned int buffer)
+{
+	if (s_VertexArray == Unknown)
+	{
+		s_Frame.IssuedBinds++;
+		GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer));
+		return;
+	}
+
+	//a VAO we have not bound an element buffer to yet starts out unknown
+	auto it = s_ElementBuffers.insert({ s_VertexArray, Unknown }).first;
+	if (Changed(it->second, buffer))
+	{
+		GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer));
+	}
+}
+
+void GLState::BindDrawIndirectBuffer(unsigned int buffer)
+{
+	if (Changed(s_DrawIndirectBuffer, buffer))
+	{
+		GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer));
+	}
+}
+
+void GLState::BindFramebuffer(unsigned int framebuffer)
+{
+	if (Changed(s_Framebuffer, framebuffer))
+	{
+		GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+	}
+}
+
+void GLState::BindUniformBuffer(unsigned int binding, unsigned int buffer)
+{
+	ASSERT(binding < MaxUniformBufferBindings);
+
+	if (Changed(s_UniformBuffers[binding], buffer))
+	{
+		GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer));
+	}
+}
+
+void GLState::BindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+{
+	ASSERT(unit < MaxTextureUnits);
+
+	if (s_Textures[unit] == texture && s_TextureTargets[unit] == target)
+	{
+		s_Frame.SkippedBinds++;
+		return;
+	}
+	if (s_ActiveTexture != unit)
+	{
+		s_ActiveTexture = unit;
+		GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+	}
+	s_TextureTargets[unit] = target;
+	s_Textures[unit] = texture;
+	s_Frame.IssuedBinds++;
+	GLCall(glBindTexture(target, texture));
+}
+
+void GLState::SetBlend(bool enabled)
+{
+	if (Changed(s_Blend, enabled))
+	{
+		if (enabled)
+		{
+			GLCall(glEnable(GL_BLEND));
+		}
+		else
+		{
+			GLCall(glDisable(GL_BLEND));
+		}
+	}
+}
+
+void GLState::SetBlendFunc(unsigned int src, unsigned int dst)
+{
+	if (s_BlendSrc == src && s_BlendDst == dst)
+	{
+		s_Frame.SkippedBinds++;
+		return;
+	}
+	s_BlendSrc = src;
+	s_BlendDst = dst;
+	s_Frame.IssuedBinds++;
+	GLCall(glBlendFunc(src, dst));
+}
+
+void GLState::SetDepthTest(bool enabled)
+{
+	if (Changed(s_DepthTest, enabled))
+	{
+		if (enabled)
+		{
+			GLCall(glEnable(GL_DEPTH_TEST));
+		}
+		else
+		{
+			GLCall(glDisable(GL_DEPTH_TEST));
+		}
+	}
+}
+
+void GLState::SetDepthMask(bool enabled)
+{
+	if (Changed(s_DepthMask, enabled))
+	{
+		GLCall(glDepthMask(enabled ? GL_TRUE : GL_FALSE));
+	}
+}
+
+void GLState::SetPrimitiveRestart(bool enabled, unsigned int indexType)
+{
+	if (Changed(s_PrimitiveRestart, enabled))
+	{
+		if (enabled)
+		{
+			GLCall(glEnable(GL_PRIMITIVE_RESTART));
+		}
+		else
+		{
+			GLCall(glDisable(GL_PRIMITIVE_RESTART));
+		}
+	}
+
+	//the index only matters while restart is on
+	if (enabled && Changed(s_PrimitiveRestartType, indexType))
+	{
+		unsigned int index = indexType == GL_UNSIGNED_BYTE ? 0xFF : indexType == GL_UNSIGNED_SHORT ? 0xFFFF : 0xFFFFFFFF;
+		GLCall(glPrimitiveRestartIndex(index));
+	}
+}
+
+void GLState::OnDeleteProgram(unsigned int program)
+{
+	//glDeleteProgram leaves a bound program in use until it is replaced,
+	//but the name may come back from glCreateProgram for a new object
+	if (s_Program == program)
+		s_Program = Unknown;
+}
+
+void GLState::OnDeleteProgramPipeline(unsigned int pipeline)
+{
+	if (s_ProgramPipeline == pipeline)
+		s_ProgramPipeline = Unknown;
+}
+
+void GLState::OnDeleteVertexArray(unsigned int vao)
+{
+	if (s_VertexArray == vao)
+		s_VertexArray = 0;
+	s_ElementBuffers.erase(vao);
+}
+
+void GLState::OnDeleteBuffer(unsigned int buffer)
+{
+	if (s_ArrayBuffer == buffer)
+		s_ArrayBuffer = 0;
+	if (s_DrawIndirectBuffer == buffer)
+		s_DrawIndirectBuffer = 0;
+	for (unsigned int i = 0; i < MaxUniformBufferBindings; i++)
+	{
+		if (s_UniformBuffers[i] == buffer)
+			s_UniformBuffers[i] = Unknown;
+	}
+	//only the current VAO drops the binding in GL, other VAOs keep a stale name
+	for (auto& binding : s_ElementBuffers)
+	{
+		if (binding.second == buffer)
+			binding.second = Unknown;
+	}
+}
+
+void GLState::OnDeleteTexture(unsigned int texture)
+{
+	for (unsigned int i = 0; i < MaxTextureUnits; i++)
+	{
+		if (s_Textures[i] == texture)
+			s_Textures[i] = 0;
+	}
+}
+
+void GLState::OnDeleteFramebuffer(unsigned int framebuffer)
+{
+	if (s_Framebuffer == framebuffer)
+		s_Framebuffer = 0;
+}
+
+void GLState::Invalidate()
+{
+	s_Program = Unknown;
+	s_ProgramPipeline = Unknown;
+	s_VertexArray = Unknown;
+	s_ArrayBuffer = Unknown;
+	s_DrawIndirectBuffer = Unknown;
+	s_Framebuffer = Unknown;
+	s_ActiveTexture = Unknown;
+	for (unsigned int i = 0; i < MaxTextureUnits; i++)
+	{
+		s_TextureTargets[i] = Unknown;
+		s_Textures[i] = Unknown;
+	}
+	for (unsigned int i = 0; i < MaxUniformBufferBindings; i++)
+		s_UniformBuffers[i] = Unknown;
+	s_Blend = Unknown;
+	s_BlendSrc = Unknown;
+	s_BlendDst = Unknown;
+	s_DepthTest = Unknown;
+	s_DepthMask = Unknown;
+	s_PrimitiveRestart = Unknown;
+	s_PrimitiveRestartType = Unknown;
+	s_ElementBuffers.clear();
+}
+
+void GLState::NewFrame()
+{
+	s_LastFrame = s_Frame;
+	s_Frame = { 0, 0 };
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <unordered_map>
+
+struct GLStateStats
+{
+	unsigned int IssuedBinds;
+	unsigned int SkippedBinds;
+};
+
+// Shadows the bits of GL context state we touch so that Bind() calls which
+// would not change anything never reach the driver.
+// All Bind()/UnBind() methods go through here; raw glBind*/glUseProgram calls
+// outside this class leave the shadow stale (call Invalidate() afterwards).
+class GLState
+{
+public:
+	static const unsigned int MaxTextureUnits = 32;
+	static const unsigned int MaxUniformBufferBindings = 16;
+
+	static void BindProgram(unsigned int program);
+	//only takes effect while no program is bound through BindProgram
+	static void BindProgramPipeline(unsigned int pipeline);
+	static void BindVertexArray(unsigned int vao);
+	static void BindArrayBuffer(unsigned int buffer);
+	static void BindElementBuffer(unsigned int buffer);
+	static void BindDrawIndirectBuffer(unsigned int buffer);
+	static void BindFramebuffer(unsigned int framebuffer);
+	//indexed binding point, as glBindBufferBase(GL_UNIFORM_BUFFER, ...)
+	static void BindUniformBuffer(unsigned int binding, unsigned int buffer);
+	static void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+
+	static void SetBlend(bool enabled);
+	static void SetBlendFunc(unsigned int src, unsigned int dst);
+	static void SetDepthTest(bool enabled);
+	static void SetDepthMask(bool enabled);
+	//the restart index is the largest value of indexType (GL_UNSIGNED_BYTE/SHORT/INT)
+	static void SetPrimitiveRestart(bool enabled, unsigned int indexType);
+
+	//deleted names may be recycled by GL, drop them from the shadow
+	static void OnDeleteProgram(unsigned int program);
+	static void OnDeleteProgramPipeline(unsigned int pipeline);
+	static void OnDeleteVertexArray(unsigned int vao);
+	static void OnDeleteBuffer(unsigned int buffer);
+	static void OnDeleteTexture(unsigned int texture);
+	static void OnDeleteFramebuffer(unsigned int framebuffer);
+
+	//forget everything we know, the next bind of each kind always goes to GL
+	static void Invalidate();
+
+	//closes the current frame's counters, call once per frame
+	static void NewFrame();
+	static const GLStateStats& GetFrameStats() { return s_LastFrame; }
+
+private:
+	static bool Changed(unsigned int& shadow, unsigned int value);
+
+	static unsigned int s_Program;
+	static unsigned int s_ProgramPipeline;
+	static unsigned int s_VertexArray;
+	static unsigned int s_ArrayBuffer;
+	static unsigned int s_DrawIndirectBuffer;
+	static unsigned int s_Framebuffer;
+	static unsigned int s_ActiveTexture;
+	static unsigned int s_TextureTargets[MaxTextureUnits];
+	static unsigned int s_Textures[MaxTextureUnits];
+	static unsigned int s_UniformBuffers[MaxUniformBufferBindings];
+	static unsigned int s_Blend;
+	static unsigned int s_BlendSrc;
+	static unsigned int s_BlendDst;
+	static unsigned int s_DepthTest;
+	static unsigned int s_DepthMask;
+	static unsigned int s_PrimitiveRestart;
+	static unsigned int s_PrimitiveRestartType;
+	//the element buffer binding is part of the VAO, so remember it per VAO
+	static std::unordered_map<unsigned int, unsigned int> s_ElementBuffers;
+
+	static GLStateStats s_Frame;
+	static GLStateStats s_LastFrame;
+};
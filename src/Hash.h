@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+//64-bit FNV-1a, usable at compile time on string literals
+const unsigned long long FnvOffsetBasis = 14695981039346656037ull;
+const unsigned long long FnvPrime = 1099511628211ull;
+
+constexpr unsigned long long HashString(const char* str, unsigned long long hash = FnvOffsetBasis)
+{
+	return *str ? HashString(str + 1, (hash ^ (unsigned char)*str) * FnvPrime) : hash;
+}
+
+//the first length chars of str, same result as HashString when there is no '\0' among them
+constexpr unsigned long long HashChars(const char* str, size_t length, unsigned long long hash = FnvOffsetBasis)
+{
+	return length ? HashChars(str + 1, length - 1, (hash ^ (unsigned char)*str) * FnvPrime) : hash;
+}
+
+inline unsigned long long HashBytes(const void* data, size_t size, unsigned long long hash = FnvOffsetBasis)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ bytes[i]) * FnvPrime;
+	return hash;
+}
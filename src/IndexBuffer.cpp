@@ -1,27 +1,205 @@
 #include "IndexBuffer.h"
 #include  "Render.h"
+#include "GLState.h"
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-	:m_Count(count)
+#include <cstring>
+#include <vector>
+
+//indices converted to the stored type, reused so steady-state updates do not allocate
+static std::vector<unsigned char> s_Scratch;
+
+static unsigned int GetMaxValue(unsigned int size)
 {
-	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
+	return size == 1 ? 0xFF : size == 2 ? 0xFFFF : 0xFFFFFFFF;
+}
 
-	GLCall(glGenBuffers(1, &m_RenderID));
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RenderID));
-	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+static unsigned int ReadIndex(const void* data, unsigned int size, unsigned int i)
+{
+	switch (size)
+	{
+	case 1:  return ((const unsigned char*)data)[i];
+	case 2:  return ((const unsigned short*)data)[i];
+	default: return ((const unsigned int*)data)[i];
+	}
+}
+
+static unsigned int FindMaxIndex(const void* data, unsigned int size, unsigned int count, bool primitiveRestart)
+{
+	if (!data)
+		return 0;
+
+	unsigned int restart = GetMaxValue(size);
+	unsigned int maxIndex = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int index = ReadIndex(data, size, i);
+		if (primitiveRestart && index == restart)
+			continue;
+		if (index > maxIndex)
+			maxIndex = index;
+	}
+	return maxIndex;
+}
+
+//returns data itself when the sizes match, otherwise the converted copy in s_Scratch
+static const void* ConvertIndices(const void* data, unsigned int inputSize, unsigned int count,
+	unsigned int outputSize, bool primitiveRestart)
+{
+	if (inputSize == outputSize)
+		return data;
+
+	s_Scratch.resize(count * outputSize);
+	unsigned int inputRestart = GetMaxValue(inputSize);
+	unsigned int outputRestart = GetMaxValue(outputSize);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int index = ReadIndex(data, inputSize, i);
+		if (primitiveRestart && index == inputRestart)
+			index = outputRestart;
+		switch (outputSize)
+		{
+		case 1:  s_Scratch[i] = (unsigned char)index; break;
+		case 2:  ((unsigned short*)s_Scratch.data())[i] = (unsigned short)index; break;
+		default: ((unsigned int*)s_Scratch.data())[i] = index; break;
+		}
+	}
+	return s_Scratch.data();
 }
 
 IndexBuffer::~IndexBuffer()
 {
+	if (m_Arena)
+	{
+		m_Arena->Free(m_Range);
+		return;
+	}
+	GLState::OnDeleteBuffer(m_RenderID);
 	GLCall(glDeleteBuffers(1, &m_RenderID));
 }
 
+unsigned int IndexBuffer::GetType() const
+{
+	switch (m_Type)
+	{
+	case IndexType::UInt8:  return GL_UNSIGNED_BYTE;
+	case IndexType::UInt16: return GL_UNSIGNED_SHORT;
+	default:                return GL_UNSIGNED_INT;
+	}
+}
+
+unsigned int IndexBuffer::GetIndexSize(IndexType type)
+{
+	switch (type)
+	{
+	case IndexType::UInt8:  return 1;
+	case IndexType::UInt16: return 2;
+	default:                return 4;
+	}
+}
+
+IndexType IndexBuffer::GetNarrowestType(unsigned int maxIndex, bool primitiveRestart)
+{
+	//a real index equal to the restart value would cut the strip
+	unsigned int reserved = primitiveRestart ? 1 : 0;
+	if (maxIndex <= 0xFFFFu - reserved)
+		return IndexType::UInt16;
+	return IndexType::UInt32;
+}
+
+void IndexBuffer::Create(const void* data, unsigned int inputSize, unsigned int count, IndexType type)
+{
+	m_RenderID = 0;
+	m_Count = count;
+	m_Range = { 0, 0, 0 };
+	m_Strategy = GetDefaultUpdateStrategy(m_Usage);
+	m_ForcedType = type != IndexType::Auto;
+	m_Type = m_ForcedType ? type : GetNarrowestType(FindMaxIndex(data, inputSize, count, m_PrimitiveRestart), m_PrimitiveRestart);
+	m_Primitive = GL_TRIANGLES;
+	ASSERT(!m_ForcedType || Fits(data, inputSize, count));
+
+	unsigned int size = count * GetIndexSize();
+	Allocate(data ? ConvertIndices(data, inputSize, count, GetIndexSize(), m_PrimitiveRestart) : nullptr, size);
+}
+
+void IndexBuffer::UpdateIndices(const void* data, unsigned int inputSize, unsigned int count)
+{
+	IndexType type = m_Type;
+	if (!m_ForcedType)
+	{
+		IndexType needed = GetNarrowestType(FindMaxIndex(data, inputSize, count, m_PrimitiveRestart), m_PrimitiveRestart);
+		if (GetIndexSize(needed) > GetIndexSize(type))
+			type = needed;
+	}
+	else
+	{
+		ASSERT(Fits(data, inputSize, count));
+	}
+
+	m_Count = count;
+	unsigned int size = count * GetIndexSize(type);
+	//a wider type needs new storage, arena ranges are also aligned to the old index size
+	if (type == m_Type && size <= m_Range.Size)
+	{
+		UpdateIndexRange(0, data, inputSize, count);
+		return;
+	}
+
+	m_Type = type;
+	const void* converted = ConvertIndices(data, inputSize, count, GetIndexSize(), m_PrimitiveRestart);
+	if (m_Arena)
+	{
+		m_Arena->Free(m_Range);
+		Allocate(converted, size);
+		return;
+	}
+
+	//grown through GL_ARRAY_BUFFER so the bound VAO keeps its element buffer
+	m_Range.Size = size;
+	GLState::BindArrayBuffer(m_RenderID);
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, converted, GetBufferUsageHint(m_Usage)));
+}
+
+void IndexBuffer::UpdateIndexRange(unsigned int first, const void* data, unsigned int inputSize, unsigned int count)
+{
+	unsigned int offset = first * GetIndexSize();
+	unsigned int size = count * GetIndexSize();
+	ASSERT(offset + size <= m_Range.Size);
+	ASSERT(Fits(data, inputSize, count));
+
+	const void* converted = ConvertIndices(data, inputSize, count, GetIndexSize(), m_PrimitiveRestart);
+	if (m_Arena)
+		m_Arena->Upload(m_Range, offset, converted, size, m_Strategy);
+	else
+		UpdateBuffer(m_RenderID, m_Range.Size, offset, converted, size, m_Usage, m_Strategy);
+}
+
+bool IndexBuffer::Fits(const void* data, unsigned int inputSize, unsigned int count) const
+{
+	return FindMaxIndex(data, inputSize, count, m_PrimitiveRestart) <= GetMaxValue(GetIndexSize()) - (m_PrimitiveRestart ? 1 : 0);
+}
+
+void IndexBuffer::Allocate(const void* data, unsigned int size)
+{
+	if (m_Arena)
+	{
+		m_Range = m_Arena->Allocate(size, GetIndexSize());
+		m_RenderID = m_Arena->GetRendererID(m_Range.Page);
+		m_Arena->Upload(m_Range, 0, data, size);
+		return;
+	}
+
+	m_Range = { 0, 0, size };
+	GLCall(glGenBuffers(1, &m_RenderID));
+	GLState::BindElementBuffer(m_RenderID);
+	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GetBufferUsageHint(m_Usage)));
+}
+
 void IndexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RenderID));
+	GLState::BindElementBuffer(m_RenderID);
 }
 
 void IndexBuffer::UnBind() const
 {
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
-}
\ No newline at end of file
+	GLState::BindElementBuffer(0);
+}
@@ -1,18 +1,113 @@
 #pragma once
 
+#include <type_traits>
+
+#include "BufferArena.h"
+
+enum class IndexType
+{
+	//16-bit when the largest index fits, 32-bit otherwise; 8-bit indices are never picked on
+	//their own, many GPUs widen them on the fly, so they have to be asked for
+	Auto,
+	UInt8,
+	UInt16,
+	UInt32
+};
+
+//either owns its GL buffer or is a view of a range in a BufferArena
+//input may be 8, 16 or 32-bit unsigned, it is stored as 16 or 32-bit (see IndexType::Auto) unless a
+//type is forced, and every index must fit the forced type
+//with primitiveRestart the largest value of the input type marks a restart and is stored as the
+//largest value of the stored type
 class IndexBuffer
 {
 private:
 	unsigned int m_RenderID;
 	unsigned int m_Count;
+	BufferRange m_Range;
+	BufferArena* m_Arena;
+	BufferUsage m_Usage;
+	BufferUpdateStrategy m_Strategy;
+	IndexType m_Type;
+	bool m_ForcedType;
+	bool m_PrimitiveRestart;
+	unsigned int m_Primitive;
 
 public:
-	IndexBuffer(const unsigned int* data, unsigned int size);
+	template<typename T>
+	IndexBuffer(const T* data, unsigned int count, BufferUsage usage = BufferUsage::Static,
+		IndexType type = IndexType::Auto, bool primitiveRestart = false)
+		:m_Arena(nullptr), m_Usage(usage), m_PrimitiveRestart(primitiveRestart)
+	{
+		static_assert(std::is_unsigned<T>::value, "indices are unsigned");
+		static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4, "indices are 8, 16 or 32-bit");
+		Create(data, sizeof(T), count, type);
+	}
+
+	template<typename T>
+	IndexBuffer(BufferArena& arena, const T* data, unsigned int count,
+		IndexType type = IndexType::Auto, bool primitiveRestart = false)
+		:m_Arena(&arena), m_Usage(arena.GetUsage()), m_PrimitiveRestart(primitiveRestart)
+	{
+		static_assert(std::is_unsigned<T>::value, "indices are unsigned");
+		static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4, "indices are 8, 16 or 32-bit");
+		Create(data, sizeof(T), count, type);
+	}
+
 	~IndexBuffer();
 
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+
+	//replaces the indices and the count, see VertexBuffer::Update; an Auto type widens when the
+	//new indices need it
+	template<typename T>
+	void Update(const T* data, unsigned int count)
+	{
+		static_assert(std::is_unsigned<T>::value, "indices are unsigned");
+		UpdateIndices(data, sizeof(T), count);
+	}
+	//overwrites count indices starting at first, the count drawn stays the same; never widens,
+	//the indices must fit the current type
+	template<typename T>
+	void UpdateRange(unsigned int first, const T* data, unsigned int count)
+	{
+		static_assert(std::is_unsigned<T>::value, "indices are unsigned");
+		UpdateIndexRange(first, data, sizeof(T), count);
+	}
+
+	inline void SetUpdateStrategy(BufferUpdateStrategy strategy) { m_Strategy = strategy; }
+	inline BufferUpdateStrategy GetUpdateStrategy() const { return m_Strategy; }
+
+	//GL_TRIANGLES unless set, e.g. GL_TRIANGLE_STRIP for strips split by restart indices
+	inline void SetPrimitive(unsigned int primitive) { m_Primitive = primitive; }
+	inline unsigned int GetPrimitive() const { return m_Primitive; }
+
 	void Bind() const;
 	void UnBind() const;
 
 	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetRendererID() const { return m_RenderID; }
+	//GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	unsigned int GetType() const;
+	inline unsigned int GetIndexSize() const { return GetIndexSize(m_Type); }
+	inline bool HasPrimitiveRestart() const { return m_PrimitiveRestart; }
+	//byte offset of the first index in the GL buffer, the indices pointer for glDrawElements
+	inline unsigned int GetOffset() const { return m_Range.Offset; }
+	inline unsigned int GetFirstIndex() const { return m_Range.Offset / GetIndexSize(); }
+	inline BufferUsage GetUsage() const { return m_Usage; }
+
+	static unsigned int GetIndexSize(IndexType type);
+	//what Auto picks for indices up to maxIndex, UInt16 or UInt32, leaving the largest value free for
+	//restarts if asked
+	static IndexType GetNarrowestType(unsigned int maxIndex, bool primitiveRestart);
+
+private:
+	//false when an index (restarts aside) does not fit the current type
+	bool Fits(const void* data, unsigned int inputSize, unsigned int count) const;
+	void Create(const void* data, unsigned int inputSize, unsigned int count, IndexType type);
+	void UpdateIndices(const void* data, unsigned int inputSize, unsigned int count);
+	void UpdateIndexRange(unsigned int first, const void* data, unsigned int inputSize, unsigned int count);
+	void Allocate(const void* data, unsigned int size);
 
 };
@@ -0,0 +1,75 @@
+#include "IndirectBuffer.h"
+#include "IndexBuffer.h"
+#include "Render.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+
+IndirectBuffer::IndirectBuffer()
+	:m_RenderID(0), m_Capacity(0), m_Dirty(false)
+{
+}
+
+IndirectBuffer::~IndirectBuffer()
+{
+	if (m_RenderID)
+	{
+		GLState::OnDeleteBuffer(m_RenderID);
+		GLCall(glDeleteBuffers(1, &m_RenderID));
+	}
+}
+
+void IndirectBuffer::AddCommand(unsigned int count, unsigned int instanceCount, unsigned int firstIndex,
+	int baseVertex, unsigned int baseInstance)
+{
+	m_Commands.push_back({ count, instanceCount, firstIndex, baseVertex, baseInstance });
+	m_Dirty = true;
+}
+
+void IndirectBuffer::AddCommand(const IndexBuffer& ib, unsigned int baseInstance, int baseVertex)
+{
+	AddCommand(ib.GetCount(), 1, ib.GetFirstIndex(), baseVertex, baseInstance);
+}
+
+void IndirectBuffer::Clear()
+{
+	m_Commands.clear();
+	m_Dirty = true;
+}
+
+void IndirectBuffer::Upload()
+{
+	//without multi-draw indirect the commands are walked on the CPU, no GL buffer needed;
+	//created here rather than in the constructor so buffers made before GLExtensions::Load work too
+	if (!GLExtensions::HasMultiDrawIndirect())
+		return;
+	if (!m_RenderID)
+	{
+		GLCall(glGenBuffers(1, &m_RenderID));
+		m_Dirty = true;
+	}
+	if (!m_Dirty)
+		return;
+
+	Bind();
+	unsigned int size = (unsigned int)(m_Commands.size() * sizeof(DrawElementsIndirectCommand));
+	if (m_Commands.size() > m_Capacity)
+	{
+		m_Capacity = (unsigned int)m_Commands.size();
+		GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, size, m_Commands.data(), GL_DYNAMIC_DRAW));
+	}
+	else
+	{
+		GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, m_Commands.data()));
+	}
+	m_Dirty = false;
+}
+
+void IndirectBuffer::Bind() const
+{
+	GLState::BindDrawIndirectBuffer(m_RenderID);
+}
+
+void IndirectBuffer::UnBind() const
+{
+	GLState::BindDrawIndirectBuffer(0);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+class IndexBuffer;
+
+//layout fixed by GL for glMultiDrawElementsIndirect
+//baseInstance is ignored below GL 4.2 / ARB_base_instance, see Render::DrawIndirect
+struct DrawElementsIndirectCommand
+{
+	unsigned int count;
+	unsigned int instanceCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int baseInstance;
+};
+
+class IndirectBuffer
+{
+private:
+	unsigned int m_RenderID;
+	unsigned int m_Capacity;
+	bool m_Dirty;
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+
+public:
+	IndirectBuffer();
+	~IndirectBuffer();
+
+	void AddCommand(unsigned int count, unsigned int instanceCount, unsigned int firstIndex,
+		int baseVertex, unsigned int baseInstance);
+	//draws every index of ib once, baseVertex as for Render::Draw
+	void AddCommand(const IndexBuffer& ib, unsigned int baseInstance = 0, int baseVertex = 0);
+	void Clear();
+
+	//copies the recorded commands to the GPU buffer if they changed, creating it on first use
+	void Upload();
+
+	void Bind() const;
+	void UnBind() const;
+
+	inline const std::vector<DrawElementsIndirectCommand>& GetCommands() const { return m_Commands; }
+	inline unsigned int GetCount() const { return (unsigned int)m_Commands.size(); }
+	inline unsigned int GetRendererID() const { return m_RenderID; }
+	inline bool IsDirty() const { return m_Dirty; }
+};
@@ -0,0 +1,284 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const unsigned int Unused = 0xFFFFFFFF;
+
+//triangles using each vertex, packed: the triangles of v are Triangles[Offsets[v] .. Offsets[v + 1])
+struct VertexAdjacency
+{
+	std::vector<unsigned int> Offsets;
+	std::vector<unsigned int> Triangles;
+};
+
+static void BuildAdjacency(VertexAdjacency& adjacency, const unsigned int* indices, unsigned int indexCount,
+	unsigned int vertexCount)
+{
+	adjacency.Offsets.assign(vertexCount + 1, 0);
+	for (unsigned int i = 0; i < indexCount; i++)
+		adjacency.Offsets[indices[i] + 1]++;
+	for (unsigned int v = 0; v < vertexCount; v++)
+		adjacency.Offsets[v + 1] += adjacency.Offsets[v];
+
+	adjacency.Triangles.resize(indexCount);
+	std::vector<unsigned int> cursor(adjacency.Offsets.begin(), adjacency.Offsets.end() - 1);
+	for (unsigned int i = 0; i < indexCount; i++)
+		adjacency.Triangles[cursor[indices[i]]++] = i / 3;
+}
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+	unsigned int cacheSize, std::vector<unsigned int>* clusters)
+{
+	//a trailing partial triangle stays where it is
+	unsigned int triangleCount = indexCount / 3;
+	indexCount = triangleCount * 3;
+	if (clusters)
+		clusters->clear();
+	if (triangleCount == 0)
+		return;
+
+	VertexAdjacency adjacency;
+	BuildAdjacency(adjacency, indices, indexCount, vertexCount);
+
+	//live triangles per vertex, the time each vertex last entered the cache
+	std::vector<unsigned int> live(vertexCount);
+	for (unsigned int v = 0; v < vertexCount; v++)
+		live[v] = adjacency.Offsets[v + 1] - adjacency.Offsets[v];
+	std::vector<unsigned int> cacheTime(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> deadEnd;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> output;
+	output.reserve(indexCount);
+
+	unsigned int time = cacheSize + 1;
+	unsigned int cursor = 0;
+	unsigned int fanning = 0;
+	bool jumped = true;
+
+	while (fanning != Unused)
+	{
+		//a non-local jump empties the cache in practice, start a new cluster there
+		unsigned int triangle = (unsigned int)output.size() / 3;
+		if (jumped && clusters && (clusters->empty() || clusters->back() != triangle))
+			clusters->push_back(triangle);
+
+		candidates.clear();
+		for (unsigned int a = adjacency.Offsets[fanning]; a < adjacency.Offsets[fanning + 1]; a++)
+		{
+			unsigned int t = adjacency.Triangles[a];
+			if (emitted[t])
+				continue;
+
+			for (unsigned int k = 0; k < 3; k++)
+			{
+				unsigned int v = indices[t * 3 + k];
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (time - cacheTime[v] > cacheSize)
+					cacheTime[v] = time++;
+			}
+			emitted[t] = true;
+		}
+
+		//the candidate still in the cache after fanning it out, with the most time left there; any
+		//live one beats jumping, even at priority 0 (the paper starts its best at -1)
+		unsigned int next = Unused;
+		int best = -1;
+		for (unsigned int v : candidates)
+		{
+			if (live[v] == 0)
+				continue;
+			int priority = 0;
+			if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+				priority = (int)(time - cacheTime[v]);
+			if (priority > best)
+			{
+				best = priority;
+				next = v;
+			}
+		}
+
+		jumped = next == Unused;
+		if (jumped)
+		{
+			//recently used vertices first, then the next one in index order
+			while (!deadEnd.empty() && next == Unused)
+			{
+				unsigned int v = deadEnd.back();
+				deadEnd.pop_back();
+				if (live[v] > 0)
+					next = v;
+			}
+			while (next == Unused && cursor < vertexCount)
+			{
+				if (live[cursor] > 0)
+					next = cursor;
+				cursor++;
+			}
+		}
+		fanning = next;
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(unsigned int));
+}
+
+void MeshOptimizer::OptimizeOverdraw(unsigned int* indices, unsigned int indexCount, const void* vertices,
+	unsigned int vertexCount, unsigned int vertexSize, const std::vector<unsigned int>& clusters)
+{
+	unsigned int triangleCount = indexCount / 3;
+	if (clusters.size() < 2 || vertexCount == 0)
+		return;
+
+	auto position = [&](unsigned int v) { return (const float*)((const char*)vertices + (size_t)v * vertexSize); };
+
+	//area weighted mesh center
+	float center[3] = { 0.0f, 0.0f, 0.0f };
+	float totalArea = 0.0f;
+	std::vector<float> triangles(triangleCount * 7);
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		const float* a = position(indices[t * 3 + 0]);
+		const float* b = position(indices[t * 3 + 1]);
+		const float* c = position(indices[t * 3 + 2]);
+		float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		//cross product, its length is twice the area
+		float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		float area = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+		float* info = &triangles[t * 7];
+		for (unsigned int k = 0; k < 3; k++)
+		{
+			info[k] = (a[k] + b[k] + c[k]) / 3.0f;
+			info[3 + k] = n[k];
+			center[k] += info[k] * area;
+		}
+		info[6] = area;
+		totalArea += area;
+	}
+	if (totalArea > 0.0f)
+	{
+		for (unsigned int k = 0; k < 3; k++)
+			center[k] /= totalArea;
+	}
+
+	//clusters facing away from the center are likely in front of the others from any view
+	struct Cluster
+	{
+		unsigned int Begin;
+		unsigned int End;
+		float Sort;
+	};
+	std::vector<Cluster> sorted(clusters.size());
+	for (unsigned int i = 0; i < clusters.size(); i++)
+	{
+		Cluster& cluster = sorted[i];
+		cluster.Begin = clusters[i];
+		cluster.End = i + 1 < clusters.size() ? clusters[i + 1] : triangleCount;
+
+		float centroid[3] = { 0.0f, 0.0f, 0.0f };
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		float area = 0.0f;
+		for (unsigned int t = cluster.Begin; t < cluster.End; t++)
+		{
+			const float* info = &triangles[t * 7];
+			for (unsigned int k = 0; k < 3; k++)
+			{
+				centroid[k] += info[k] * info[6];
+				normal[k] += info[3 + k];
+			}
+			area += info[6];
+		}
+		float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		cluster.Sort = 0.0f;
+		if (area > 0.0f && length > 0.0f)
+		{
+			for (unsigned int k = 0; k < 3; k++)
+				cluster.Sort += (centroid[k] / area - center[k]) * normal[k] / length;
+		}
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.Sort > b.Sort; });
+
+	std::vector<unsigned int> original(indices, indices + triangleCount * 3);
+	unsigned int* out = indices;
+	for (const Cluster& cluster : sorted)
+	{
+		unsigned int count = (cluster.End - cluster.Begin) * 3;
+		memcpy(out, &original[cluster.Begin * 3], count * sizeof(unsigned int));
+		out += count;
+	}
+}
+
+unsigned int MeshOptimizer::OptimizeVertexFetch(void* vertices, unsigned int vertexCount, unsigned int vertexSize,
+	unsigned int* indices, unsigned int indexCount)
+{
+	std::vector<unsigned int> remap(vertexCount, Unused);
+	unsigned int next = 0;
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		unsigned int& index = remap[indices[i]];
+		if (index == Unused)
+			index = next++;
+		indices[i] = index;
+	}
+
+	std::vector<char> original((const char*)vertices, (const char*)vertices + (size_t)vertexCount * vertexSize);
+	for (unsigned int v = 0; v < vertexCount; v++)
+	{
+		if (remap[v] != Unused)
+			memcpy((char*)vertices + (size_t)remap[v] * vertexSize, &original[(size_t)v * vertexSize], vertexSize);
+	}
+	return next;
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount,
+	unsigned int vertexCount, unsigned int cacheSize)
+{
+	VertexCacheStats stats = { 0.0f, 0.0f };
+	if (indexCount < 3)
+		return stats;
+
+	//a vertex is cached while fewer than cacheSize misses happened since it was loaded
+	std::vector<unsigned int> loadedAt(vertexCount, Unused);
+	std::vector<bool> used(vertexCount, false);
+	unsigned int misses = 0;
+	unsigned int unique = 0;
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		unsigned int v = indices[i];
+		if (loadedAt[v] == Unused || misses - loadedAt[v] >= cacheSize)
+		{
+			loadedAt[v] = misses;
+			misses++;
+		}
+		if (!used[v])
+		{
+			used[v] = true;
+			unique++;
+		}
+	}
+
+	stats.ACMR = (float)misses / (indexCount / 3);
+	stats.ATVR = (float)misses / unique;
+	return stats;
+}
+
+MeshOptimizeReport MeshOptimizer::Optimize(void* vertices, unsigned int vertexCount, unsigned int vertexSize,
+	unsigned int* indices, unsigned int indexCount, unsigned int cacheSize)
+{
+	MeshOptimizeReport report;
+	report.Before = AnalyzeVertexCache(indices, indexCount, vertexCount, cacheSize);
+
+	std::vector<unsigned int> clusters;
+	OptimizeVertexCache(indices, indexCount, vertexCount, cacheSize, &clusters);
+	OptimizeOverdraw(indices, indexCount, vertices, vertexCount, vertexSize, clusters);
+	report.VertexCount = OptimizeVertexFetch(vertices, vertexCount, vertexSize, indices, indexCount);
+
+	report.After = AnalyzeVertexCache(indices, indexCount, report.VertexCount, cacheSize);
+	return report;
+}
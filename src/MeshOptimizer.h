@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+//post-transform vertex cache behaviour of an index list, lower is better for both
+struct VertexCacheStats
+{
+	//average cache miss ratio, vertex shader runs per triangle (0.5 at best, 3 at worst)
+	float ACMR;
+	//average transform to vertex ratio, vertex shader runs per unique vertex (1 at best)
+	float ATVR;
+};
+
+struct MeshOptimizeReport
+{
+	VertexCacheStats Before;
+	VertexCacheStats After;
+	//vertices left after OptimizeVertexFetch dropped the unreferenced ones
+	unsigned int VertexCount;
+};
+
+// Reorders triangle list indices (and vertices) before they go to an
+// IndexBuffer/VertexBuffer, offline or at load time:
+//  - OptimizeVertexCache: Tipsify (Sander et al. 2007), triangles are emitted
+//    around recently used vertices so the post-transform cache hits more
+//  - OptimizeOverdraw: sorts the clusters Tipsify produced so the ones facing
+//    outwards from the mesh center come first and occlude the rest
+//  - OptimizeVertexFetch: renumbers vertices in first-use order so the vertex
+//    buffer is read front to back
+// Strips and restart indices are not handled, convert them to lists first.
+// Indices after the last whole triangle are left untouched.
+class MeshOptimizer
+{
+public:
+	static const unsigned int DefaultCacheSize = 16;
+
+	//clusters, if given, receives the first triangle of each cluster for OptimizeOverdraw
+	static void OptimizeVertexCache(unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+		unsigned int cacheSize = DefaultCacheSize, std::vector<unsigned int>* clusters = nullptr);
+	//positions are three floats at the start of every vertexSize bytes
+	static void OptimizeOverdraw(unsigned int* indices, unsigned int indexCount, const void* vertices,
+		unsigned int vertexCount, unsigned int vertexSize, const std::vector<unsigned int>& clusters);
+	//moves the vertices in place and rewrites indices to match, returns the number of vertices still used
+	static unsigned int OptimizeVertexFetch(void* vertices, unsigned int vertexCount, unsigned int vertexSize,
+		unsigned int* indices, unsigned int indexCount);
+
+	//simulates a FIFO cache of cacheSize entries
+	static VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount,
+		unsigned int vertexCount, unsigned int cacheSize = DefaultCacheSize);
+
+	//runs all three passes in order
+	static MeshOptimizeReport Optimize(void* vertices, unsigned int vertexCount, unsigned int vertexSize,
+		unsigned int* indices, unsigned int indexCount, unsigned int cacheSize = DefaultCacheSize);
+};
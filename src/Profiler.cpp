@@ -0,0 +1,265 @@
+#include "Profiler.h"
+#include "Render.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+bool Profiler::s_Initialized = false;
+bool Profiler::s_GpuTiming = false;
+bool Profiler::s_InFrame = false;
+unsigned int Profiler::s_Depth = 0;
+unsigned long long Profiler::s_FrameIndex = 0;
+int Profiler::s_FrameZone = -1;
+long long Profiler::s_GpuEpoch = 0;
+Profiler::Frame Profiler::s_Frames[Profiler::FramesInFlight];
+std::deque<ProfileFrameResult> Profiler::s_History;
+
+static std::chrono::high_resolution_clock::time_point s_CpuEpoch;
+
+long long Profiler::CpuNow()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::high_resolution_clock::now() - s_CpuEpoch).count();
+}
+
+void Profiler::Init()
+{
+	s_CpuEpoch = std::chrono::high_resolution_clock::now();
+
+	//GL_TIMESTAMP is core in 3.3, but a zero counter width means the driver has no timer
+	int bits = 0;
+	GLCall(glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits));
+	s_GpuTiming = bits > 0;
+	if (s_GpuTiming)
+	{
+		//GPU timestamps are mapped onto the CPU timeline through this pair
+		GLint64 now = 0;
+		GLCall(glGetInteger64v(GL_TIMESTAMP, &now));
+		s_GpuEpoch = now - CpuNow();
+	}
+
+	for (Frame& frame : s_Frames)
+	{
+		frame.Pending = false;
+		frame.QueriesUsed = 0;
+	}
+	s_Initialized = true;
+}
+
+void Profiler::Shutdown()
+{
+	if (s_Initialized)
+	{
+		//the last FramesInFlight frames were never read back, finish them oldest first
+		GLCall(glFinish());
+		for (unsigned int i = 0; i < FramesInFlight; i++)
+		{
+			Frame& frame = s_Frames[(s_FrameIndex + i) % FramesInFlight];
+			if (frame.Pending && frame.Index < s_FrameIndex)
+				Resolve(frame);
+		}
+	}
+
+	for (Frame& frame : s_Frames)
+	{
+		if (!frame.Queries.empty())
+		{
+			GLCall(glDeleteQueries((GLsizei)frame.Queries.size(), frame.Queries.data()));
+		}
+		frame.Queries.clear();
+		frame.Zones.clear();
+		frame.Pending = false;
+	}
+	s_Initialized = false;
+}
+
+void Profiler::BeginFrame()
+{
+	if (!s_Initialized)
+		return;
+
+	Frame& frame = s_Frames[s_FrameIndex % FramesInFlight];
+	if (frame.Pending)
+		Resolve(frame);
+
+	frame.Index = s_FrameIndex;
+	frame.Pending = true;
+	frame.Zones.clear();
+	frame.QueriesUsed = 0;
+
+	s_InFrame = true;
+	s_Depth = 0;
+	s_FrameZone = BeginZone("Frame");
+}
+
+void Profiler::EndFrame()
+{
+	if (!s_InFrame)
+		return;
+
+	EndZone(s_FrameZone);
+	s_InFrame = false;
+	s_FrameIndex++;
+}
+
+int Profiler::BeginZone(const char* name)
+{
+	if (!s_InFrame)
+		return -1;
+
+	Frame& frame = s_Frames[s_FrameIndex % FramesInFlight];
+	int query = -1;
+	if (s_GpuTiming)
+	{
+		query = AllocateQueries(frame);
+		GLCall(glQueryCounter(frame.Queries[query], GL_TIMESTAMP));
+	}
+	frame.Zones.push_back({ name, s_Depth++, CpuNow(), 0, query });
+	return (int)frame.Zones.size() - 1;
+}
+
+void Profiler::EndZone(int zone)
+{
+	if (zone < 0 || !s_InFrame)
+		return;
+
+	Frame& frame = s_Frames[s_FrameIndex % FramesInFlight];
+	Zone& z = frame.Zones[zone];
+	z.CpuEnd = CpuNow();
+	if (z.Query >= 0)
+	{
+		GLCall(glQueryCounter(frame.Queries[z.Query + 1], GL_TIMESTAMP));
+	}
+	s_Depth--;
+}
+
+int Profiler::AllocateQueries(Frame& frame)
+{
+	if (frame.QueriesUsed + 2 > frame.Queries.size())
+	{
+		unsigned int grow = frame.Queries.empty() ? 64 : (unsigned int)frame.Queries.size();
+		frame.Queries.resize(frame.Queries.size() + grow);
+		GLCall(glGenQueries(grow, &frame.Queries[frame.Queries.size() - grow]));
+	}
+	int first = frame.QueriesUsed;
+	frame.QueriesUsed += 2;
+	return first;
+}
+
+void Profiler::Resolve(Frame& frame)
+{
+	frame.Pending = false;
+
+	ProfileFrameResult result;
+	result.Index = frame.Index;
+	result.CpuMs = 0.0;
+	result.GpuMs = -1.0;
+	result.Zones.reserve(frame.Zones.size());
+	for (const Zone& zone : frame.Zones)
+	{
+		ProfileZoneResult r = { zone.Name, zone.Depth, zone.CpuBegin / 1000.0,
+			(zone.CpuEnd - zone.CpuBegin) / 1000.0, -1.0, -1.0 };
+		if (zone.Query >= 0 && zone.CpuEnd != 0 && IsAvailable(frame, zone.Query))
+		{
+			GLuint64 begin = 0, end = 0;
+			GLCall(glGetQueryObjectui64v(frame.Queries[zone.Query], GL_QUERY_RESULT, &begin));
+			GLCall(glGetQueryObjectui64v(frame.Queries[zone.Query + 1], GL_QUERY_RESULT, &end));
+			r.GpuStart = ((long long)begin - s_GpuEpoch) / 1000.0;
+			r.GpuDuration = (end - begin) / 1000.0;
+		}
+		result.Zones.push_back(r);
+	}
+	//zone 0 is the frame zone opened by BeginFrame
+	if (!result.Zones.empty())
+	{
+		result.CpuMs = result.Zones[0].CpuDuration / 1000.0;
+		if (result.Zones[0].GpuDuration >= 0.0)
+			result.GpuMs = result.Zones[0].GpuDuration / 1000.0;
+	}
+
+	s_History.push_back(std::move(result));
+	if (s_History.size() > MaxHistory)
+		s_History.pop_front();
+}
+
+bool Profiler::IsAvailable(const Frame& frame, int query)
+{
+	//FramesInFlight frames later the results are normally in; if they are not, the GPU side of
+	//the zone is dropped rather than waited for. Both queries are checked, GL does not promise
+	//that results become available in the order the queries were issued
+	for (int i = query; i < query + 2; i++)
+	{
+		GLint available = 0;
+		GLCall(glGetQueryObjectiv(frame.Queries[i], GL_QUERY_RESULT_AVAILABLE, &available));
+		if (!available)
+			return false;
+	}
+	return true;
+}
+
+static void WriteJsonString(std::ostream& stream, const char* text)
+{
+	stream << '"';
+	for (const char* c = text; *c; c++)
+	{
+		switch (*c)
+		{
+		case '"':  stream << "\\\""; break;
+		case '\\': stream << "\\\\"; break;
+		case '\n': stream << "\\n"; break;
+		case '\t': stream << "\\t"; break;
+		default:
+			if ((unsigned char)*c < 0x20)
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*c);
+				stream << escaped;
+			}
+			else
+			{
+				stream << *c;
+			}
+		}
+	}
+	stream << '"';
+}
+
+const ProfileFrameResult* Profiler::GetLastResult()
+{
+	return s_History.empty() ? nullptr : &s_History.back();
+}
+
+bool Profiler::WriteChromeTrace(const std::string& filePath)
+{
+	std::ofstream stream(filePath);
+	if (!stream)
+		return false;
+
+	//chrome://tracing "complete" events, CPU zones on tid 1 and GPU zones on tid 2
+	stream << "{\"traceEvents\":[";
+	bool first = true;
+	for (const ProfileFrameResult& frame : s_History)
+	{
+		for (const ProfileZoneResult& zone : frame.Zones)
+		{
+			stream << (first ? "" : ",") << "\n{\"name\":";
+			WriteJsonString(stream, zone.Name);
+			stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+				<< ",\"ts\":" << zone.CpuStart << ",\"dur\":" << zone.CpuDuration
+				<< ",\"args\":{\"frame\":" << frame.Index << "}}";
+			first = false;
+			if (zone.GpuDuration >= 0.0)
+			{
+				stream << ",\n{\"name\":";
+				WriteJsonString(stream, zone.Name);
+				stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":2"
+					<< ",\"ts\":" << zone.GpuStart << ",\"dur\":" << zone.GpuDuration
+					<< ",\"args\":{\"frame\":" << frame.Index << "}}";
+			}
+		}
+	}
+	stream << "\n],\"otherData\":{\"tid 1\":\"CPU\",\"tid 2\":\"GPU\"}}\n";
+	return true;
+}
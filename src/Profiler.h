@@ -0,0 +1,114 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+
+// PROFILE_SCOPE("shadow pass") times the enclosing scope on the CPU and, when
+// the context has timer queries, on the GPU with a pair of GL_TIMESTAMP queries.
+// Queries are kept per frame in a ring of FramesInFlight slots and only read
+// back when a slot comes round again, so measuring never waits on the GPU.
+// Scopes are compiled in for debug builds only, define PROFILE_ENABLED to override.
+#ifndef PROFILE_ENABLED
+#ifdef _DEBUG
+#define PROFILE_ENABLED 1
+#else
+#define PROFILE_ENABLED 0
+#endif
+#endif
+
+#if PROFILE_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+struct ProfileZoneResult
+{
+	const char* Name;
+	unsigned int Depth;
+	//microseconds since Profiler::Init
+	double CpuStart;
+	double CpuDuration;
+	//negative when the GPU time is not known
+	double GpuStart;
+	double GpuDuration;
+};
+
+struct ProfileFrameResult
+{
+	unsigned long long Index;
+	double CpuMs;
+	double GpuMs;
+	std::vector<ProfileZoneResult> Zones;
+};
+
+class Profiler
+{
+public:
+	static const unsigned int FramesInFlight = 4;
+	static const unsigned int MaxHistory = 600;
+
+	//needs a current context, Shutdown waits for the GPU and resolves the frames still in flight
+	static void Init();
+	static void Shutdown();
+
+	//BeginFrame opens a "Frame" zone that EndFrame closes, zones outside a frame are ignored
+	static void BeginFrame();
+	static void EndFrame();
+
+	static int BeginZone(const char* name);
+	static void EndZone(int zone);
+
+	//last frame whose GPU results have come back, nullptr before the ring has filled
+	static const ProfileFrameResult* GetLastResult();
+	static bool WriteChromeTrace(const std::string& filePath);
+
+private:
+	struct Zone
+	{
+		const char* Name;
+		unsigned int Depth;
+		long long CpuBegin;
+		long long CpuEnd;
+		//first of two timestamp queries, -1 without GPU timing
+		int Query;
+	};
+
+	struct Frame
+	{
+		unsigned long long Index;
+		bool Pending;
+		std::vector<Zone> Zones;
+		std::vector<unsigned int> Queries;
+		unsigned int QueriesUsed;
+	};
+
+	static long long CpuNow();
+	static int AllocateQueries(Frame& frame);
+	static void Resolve(Frame& frame);
+	static bool IsAvailable(const Frame& frame, int query);
+
+	static bool s_Initialized;
+	static bool s_GpuTiming;
+	static bool s_InFrame;
+	static unsigned int s_Depth;
+	static unsigned long long s_FrameIndex;
+	static int s_FrameZone;
+	static long long s_GpuEpoch;
+	static Frame s_Frames[FramesInFlight];
+	static std::deque<ProfileFrameResult> s_History;
+};
+
+class ProfileScope
+{
+private:
+	int m_Zone;
+
+public:
+	ProfileScope(const char* name)
+		:m_Zone(Profiler::BeginZone(name)) {}
+	~ProfileScope() { Profiler::EndZone(m_Zone); }
+};
@@ -1,6 +1,10 @@
 #include "Render.h"
+#include "GLExtensions.h"
+#include "Profiler.h"
+#include "GLState.h"
 
 #include <iostream>
+#include <utility>
 
 void GLClearError()
 {
@@ -9,27 +13,215 @@ void GLClearError()
 
 bool GLLogCall(const char* function, const char* file, int line)
 {
+	bool ok = true;
 	while (GLenum error = glGetError())
 	{
-		std::cout << "[OpenGL Error] (" << error << ") " << function
-			<< " " << file << ": " << line << std::endl;
-		std::cin.get();
-		return false;
+		GLDebug::Report({ 0, GL_DEBUG_TYPE_ERROR, error, GL_DEBUG_SEVERITY_HIGH, "glGetError", function, file, line });
+		ok = false;
 	}
-	return true;
+	//the caller is about to break, get the reports out first
+	if (!ok)
+		GLDebug::FlushMessages();
+	return ok;
 }
 
-void Render::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
+void Render::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, int baseVertex) const
 {
+	PROFILE_SCOPE("Render::Draw");
+
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+
+	DrawElements(ib, baseVertex, 1);
+}
+
+void Render::DrawArrays(const VertexArray& va, const Shader& shader, unsigned int first, unsigned int count) const
+{
+	shader.Bind();
+	va.Bind();
+
+	GLCall(glDrawArrays(GL_TRIANGLES, first, count));
+	m_Stats.Draws++;
+	m_Stats.Triangles += count / 3;
+}
+
+void Render::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount,
+	int baseVertex) const
+{
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+
+	DrawElements(ib, baseVertex, instanceCount);
+}
+
+void Render::DrawElements(const IndexBuffer& ib, int baseVertex, unsigned int instanceCount) const
+{
+	//restart has to be turned off again for buffers that may hold the restart value as a real index
+	GLState::SetPrimitiveRestart(ib.HasPrimitiveRestart(), ib.GetType());
+
+	//arena buffers start somewhere inside a shared GL buffer
+	const void* indices = (const void*)(size_t)ib.GetOffset();
+	if (instanceCount != 1)
+	{
+		GLCall(glDrawElementsInstancedBaseVertex(ib.GetPrimitive(), ib.GetCount(), ib.GetType(), indices,
+			instanceCount, baseVertex));
+	}
+	else if (baseVertex != 0)
+	{
+		GLCall(glDrawElementsBaseVertex(ib.GetPrimitive(), ib.GetCount(), ib.GetType(), indices, baseVertex));
+	}
+	else
+	{
+		GLCall(glDrawElements(ib.GetPrimitive(), ib.GetCount(), ib.GetType(), indices));
+	}
+	m_Stats.Draws++;
+	m_Stats.Triangles += GetTriangleCount(ib.GetPrimitive(), ib.GetCount()) * instanceCount;
+}
+
+unsigned long long Render::GetTriangleCount(unsigned int primitive, unsigned int count)
+{
+	//strips count as unbroken, restarts make this an upper bound
+	switch (primitive)
+	{
+	case GL_TRIANGLES:      return count / 3;
+	case GL_TRIANGLE_STRIP:
+	case GL_TRIANGLE_FAN:   return count > 2 ? count - 2 : 0;
+	default:                return 0;
+	}
+}
+
+void Render::DrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, IndirectBuffer& commands) const
+{
+	if (commands.GetCount() == 0)
+		return;
+
+	for (const DrawElementsIndirectCommand& cmd : commands.GetCommands())
+		m_Stats.Triangles += GetTriangleCount(ib.GetPrimitive(), cmd.count) * cmd.instanceCount;
+
 	shader.Bind();
 	va.Bind();
 	ib.Bind();
+	GLState::SetPrimitiveRestart(ib.HasPrimitiveRestart(), ib.GetType());
+
+	//looked up once per batch so shaders without it cost nothing per draw
+	Uniform<int> drawID(shader.GetUniforms().Find("u_DrawID"));
+	//the multi-draw cannot change a uniform between commands, so it only serves shaders without one
+	if (GLExtensions::HasMultiDrawIndirect() && !drawID.IsValid())
+	{
+		commands.Upload();
+		ASSERT(commands.GetRendererID() != 0);
+		commands.Bind();
+		GLCall(GLExtensions::MultiDrawElementsIndirect(ib.GetPrimitive(), ib.GetType(), nullptr, commands.GetCount(), 0));
+		//per command like the fallback below, so draws per second compare across both paths
+		m_Stats.Draws += commands.GetCount();
+		return;
+	}
+
+	const auto& list = commands.GetCommands();
+	for (unsigned int i = 0; i < list.size(); i++)
+	{
+		const DrawElementsIndirectCommand& cmd = list[i];
+		const void* offset = (const void*)(size_t)(cmd.firstIndex * ib.GetIndexSize());
+		shader.Upload(drawID, (int)i);
+		if (GLExtensions::HasBaseInstance())
+		{
+			GLCall(GLExtensions::DrawElementsInstancedBaseVertexBaseInstance(ib.GetPrimitive(), cmd.count, ib.GetType(),
+				offset, cmd.instanceCount, cmd.baseVertex, cmd.baseInstance));
+		}
+		else
+		{
+			//no baseInstance below GL 4.2, per-instance attributes start at 0 for every draw
+			GLCall(glDrawElementsInstancedBaseVertex(ib.GetPrimitive(), cmd.count, ib.GetType(),
+				offset, cmd.instanceCount, cmd.baseVertex));
+		}
+		m_Stats.Draws++;
+	}
+}
 
-	GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+void Render::Submit(const VertexArray& va, const IndexBuffer& ib, const Shader& shader,
+	unsigned int pass, float depth, int baseVertex)
+{
+	m_Queue.push_back({ MakeSortKey(pass, shader.GetRendererID(), va.GetRendererID(), depth), &va, &ib, &shader,
+		baseVertex });
+}
+
+void Render::Flush()
+{
+	SortQueue();
+
+	for (const DrawPacket& packet : m_Queue)
+	{
+		//GLState drops the binds that match the previous packet
+		packet.shader->Bind();
+		packet.va->Bind();
+		packet.ib->Bind();
+
+		DrawElements(*packet.ib, packet.BaseVertex, 1);
+	}
+	m_Queue.clear();
+}
+
+unsigned long long Render::MakeSortKey(unsigned int pass, unsigned int shader, unsigned int vao, float depth)
+{
+	const unsigned long long mask20 = (1ull << 20) - 1;
+
+	//pass 16 would wrap to 0 and sort ahead of everything
+	ASSERT(pass < 16);
+	if (depth < 0.0f) depth = 0.0f;
+	if (depth > 1.0f) depth = 1.0f;
+	unsigned long long depthBucket = (unsigned long long)(depth * mask20);
+
+	//GL names beyond 20 bits only weaken the grouping, packets keep their own pointers
+	return ((unsigned long long)(pass & 0xF) << 60)
+		| (((unsigned long long)shader & mask20) << 40)
+		| (((unsigned long long)vao & mask20) << 20)
+		| depthBucket;
+}
+
+void Render::SortQueue()
+{
+	//LSD radix sort, 8 bits per pass, stable so equal keys keep submission order
+	const size_t count = m_Queue.size();
+	if (count < 2)
+		return;
+
+	m_SortScratch.resize(count);
+	DrawPacket* src = m_Queue.data();
+	DrawPacket* dst = m_SortScratch.data();
+
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		size_t histogram[256] = { 0 };
+		for (size_t i = 0; i < count; i++)
+			histogram[(src[i].Key >> shift) & 0xFF]++;
+
+		//every key shares this byte, the pass would not move anything
+		if (histogram[(src[0].Key >> shift) & 0xFF] == count)
+			continue;
+
+		size_t offset = 0;
+		for (unsigned int b = 0; b < 256; b++)
+		{
+			size_t n = histogram[b];
+			histogram[b] = offset;
+			offset += n;
+		}
+		for (size_t i = 0; i < count; i++)
+			dst[histogram[(src[i].Key >> shift) & 0xFF]++] = src[i];
+
+		std::swap(src, dst);
+	}
+
+	if (src != m_Queue.data())
+		m_Queue.swap(m_SortScratch);
 }
 
 void Render::Clear() const
 {
+	PROFILE_SCOPE("Render::Clear");
+
 	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 }
@@ -1,24 +1,91 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <vector>
 
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "IndirectBuffer.h"
+#include "GLDebug.h"
 
 #define ASSERT(x) if (!(x)) __debugbreak();
-#define GLCall(x) GLClearError();\
+//expands to several statements, brace it when used as the body of an if/else
+#if GLCALL_MODE == GLCALL_MODE_OFF && defined(GLCALL_COUNT)
+#define GLCall(x) GLDebug::CountCall();\
+	x
+#elif GLCALL_MODE == GLCALL_MODE_OFF
+#define GLCall(x) x
+#else
+#define GLCall(x) GLDebug::BeginCall(#x, __FILE__, __LINE__);\
 	x;\
-	ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+	ASSERT(GLDebug::EndCall())
+#endif
 
 
 void GLClearError();
 bool GLLogCall(const char* function, const char* file, int line);
 
+//one recorded draw, the key orders the queue by pass, shader, VAO and depth
+struct DrawPacket
+{
+	unsigned long long Key;
+	const VertexArray* va;
+	const IndexBuffer* ib;
+	const Shader* shader;
+	int BaseVertex;
+};
+
+//what the draws since the last ResetStats() put on screen
+struct RenderStats
+{
+	//draw commands, a multi-draw counts each of its commands
+	unsigned long long Draws;
+	unsigned long long Triangles;
+};
+
 class Render
 {
+private:
+	std::vector<DrawPacket> m_Queue;
+	std::vector<DrawPacket> m_SortScratch;
+	mutable RenderStats m_Stats;
+
 public: 
-	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+	Render()
+		:m_Stats({ 0, 0 }) {}
+
+	//baseVertex is VertexBuffer::GetBaseVertex() when va is shared by meshes of one BufferArena
+	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, int baseVertex = 0) const;
+	//non-indexed triangles, e.g. vertices written to a StreamingBuffer this frame
+	void DrawArrays(const VertexArray& va, const Shader& shader, unsigned int first, unsigned int count) const;
+	void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount,
+		int baseVertex = 0) const;
+	//issues every command in one glMultiDrawElementsIndirect when GL 4.3 is available,
+	//otherwise loops over them with per-draw calls. A shader with an active "u_DrawID" always
+	//takes the loop and gets the command index there, on every GL version (gl_DrawID would need
+	//GL 4.6 / ARB_shader_draw_parameters). baseInstance needs GL 4.2 / ARB_base_instance,
+	//without it the loop starts per-instance attributes at 0 for every command
+	void DrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, IndirectBuffer& commands) const;
 	void Clear() const;
 
+	//deferred path: Submit() records a packet, Flush() sorts the queue by state and issues it
+	//pass is the top 4 bits of the sort key so it must be below 16, depth is expected in [0, 1],
+	//objects must stay alive until Flush()
+	void Submit(const VertexArray& va, const IndexBuffer& ib, const Shader& shader,
+		unsigned int pass = 0, float depth = 0.0f, int baseVertex = 0);
+	void Flush();
+
+	inline unsigned int GetQueuedCount() const { return (unsigned int)m_Queue.size(); }
+	inline const RenderStats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = { 0, 0 }; }
+
+	//pass:4 | shader:20 | VAO:20 | depth:20, from most to least significant bit
+	static unsigned long long MakeSortKey(unsigned int pass, unsigned int shader, unsigned int vao, float depth);
+
+private:
+	void SortQueue();
+	void DrawElements(const IndexBuffer& ib, int baseVertex, unsigned int instanceCount) const;
+	static unsigned long long GetTriangleCount(unsigned int primitive, unsigned int count);
+
 };
\ No newline at end of file
@@ -1,116 +1,752 @@
 #include "Shader.h"
 #include "Render.h"
+#include "GLState.h"
+#include "ShaderCache.h"
+#include "ShaderPipeline.h"
+#include "GLExtensions.h"
+#include "UniformBuffer.h"
+#include "FileWatcher.h"
+#include "Hash.h"
 
 #include <iostream>
-#include <fstream>
+#include <chrono>
+#include <cstring>
 #include <string>
-#include <sstream>
+#include <algorithm>
+#include <memory>
 
-Shader::Shader(const std::string& filepath)
-	:m_FilePath(filepath), m_RendererID(0)
+std::vector<Shader*> Shader::s_Pending;
+std::vector<Shader*> Shader::s_Shaders;
+unsigned int Shader::s_Placeholder = 0;
+
+static std::unique_ptr<FileWatcher> s_Watcher;
+
+Shader::Shader(const std::string& filepath, ShaderLoadMode mode)
+	:Shader(filepath, std::vector<std::string>(), mode)
+{
+}
+
+Shader::Shader(const std::string& filepath, const std::vector<std::string>& defines, ShaderLoadMode mode)
+	:m_RendererID(0), m_Separable(false), m_Spirv(false), m_StagePrograms(), m_FilePath(filepath), m_Defines(defines),
+	m_UploadStats({ 0, 0 }), m_PendingProgram(0), m_CacheKey(0)
 {
-	ShaderProgramSource source = ParseShader(filepath);
-	std::cout << "VERTEX" << std::endl;
-	std::cout << source.VertexSource << std::endl;
-	std::cout << "FRAGMENT" << std::endl;
-	std::cout << source.FragmentSource << std::endl;
+	if (mode == ShaderLoadMode::Separable && !ShaderPipeline::IsSupported())
+		mode = ShaderLoadMode::Blocking;
+	m_Separable = mode == ShaderLoadMode::Separable;
+	s_Shaders.push_back(this);
+
+	ShaderProgramSource source;
+	bool parsed = ShaderParser::Parse(filepath, source);
+	//the chunks Parse loaded list the includes; a broken file is watched too, fixing it reloads
+	if (s_Watcher)
+		WatchFiles();
+	if (!parsed)
+	{
+		//like a failed reload, except there is no program to keep; a reload of the fixed file replaces it
+		std::cout << "Failed to load " << filepath << ", using the placeholder program" << std::endl;
+		m_Separable = false;
+		m_RendererID = GetPlaceholder();
+		return;
+	}
+	InjectDefines(source, defines, m_Separable);
+	for (unsigned int i = 0; i < ShaderStageCount; i++)
+	{
+		if (!source.HasStage((ShaderStage)i))
+			continue;
+		std::cout << GetShaderStageName((ShaderStage)i) << std::endl;
+		for (const ShaderSourceSpan& span : source.Stages[i])
+			std::cout.write(span.Data, span.Length);
+		std::cout << std::endl;
+	}
+
+	if (m_Separable)
+	{
+		if (!GetStagePrograms(source, m_StagePrograms))
+		{
+			//same fallback as a failed Parse
+			std::cout << "Failed to load " << filepath << ", using the placeholder program" << std::endl;
+			m_Separable = false;
+			m_RendererID = GetPlaceholder();
+			return;
+		}
+		m_RendererID = ShaderPipeline::GetPipeline(m_StagePrograms);
+		ReflectProgram();
+		return;
+	}
 
-	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+	//a cooked pack skips the GLSL front end; defines only exist on the GLSL path
+	if (defines.empty() && GLExtensions::HasSpirv())
+	{
+		SpirvPack pack;
+		if (ShaderCooker::Load(filepath, ShaderCooker::MakeSourceKey(source), pack))
+			m_RendererID = CreateSpirvProgram(pack);
+		if (m_RendererID)
+		{
+			m_Spirv = true;
+			m_SpirvUniforms = pack.Uniforms;
+			m_SpirvBlocks = pack.Blocks;
+			ReflectProgram();
+			return;
+		}
+	}
+
+	unsigned long long cacheKey = ShaderCache::MakeKey(source);
+	m_RendererID = ShaderCache::Load(cacheKey, filepath);
+	if (m_RendererID == 0 && mode == ShaderLoadMode::Async)
+	{
+		SubmitAsync(source);
+		m_RendererID = GetPlaceholder();
+	}
+	else if (m_RendererID == 0)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		m_RendererID = CreateShader(source);
+		std::chrono::duration<double, std::milli> compileTime = std::chrono::high_resolution_clock::now() - start;
+		ShaderCache::Store(cacheKey, m_RendererID, compileTime.count(), filepath);
+	}
+
+	if (IsReady())
+		ReflectProgram();
 }
 
 Shader::~Shader()
 {
+	s_Shaders.erase(std::remove(s_Shaders.begin(), s_Shaders.end(), this), s_Shaders.end());
+	//stage programs and pipelines belong to ShaderPipeline, other shaders may be using them
+	if (m_Separable)
+	{
+		ReleaseStagePrograms(m_StagePrograms);
+		return;
+	}
+
+	if (m_PendingProgram)
+		CancelPending();
+	if (m_RendererID == s_Placeholder)
+		return;
+	GLState::OnDeleteProgram(m_RendererID);
 	GLCall(glDeleteProgram(m_RendererID));
+	UniformTable::ForgetProgram(m_RendererID);
+}
+
+void Shader::SubmitAsync(const ShaderProgramSource& source)
+{
+	m_CacheKey = ShaderCache::MakeKey(source);
+	m_CompileStart = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < ShaderStageCount; i++)
+	{
+		if (source.HasStage((ShaderStage)i))
+			m_PendingStages.push_back(SubmitShader(GetShaderStageType((ShaderStage)i), source.Stages[i]));
+	}
+	m_PendingProgram = SubmitProgram(m_PendingStages);
+	s_Pending.push_back(this);
+}
+
+void Shader::CancelPending()
+{
+	s_Pending.erase(std::remove(s_Pending.begin(), s_Pending.end(), this), s_Pending.end());
+	for (unsigned int stage : m_PendingStages)
+	{
+		GLCall(glDeleteShader(stage));
+	}
+	GLCall(glDeleteProgram(m_PendingProgram));
+	m_PendingProgram = 0;
+	m_PendingStages.clear();
+}
+
+void Shader::ReplaceProgram(unsigned int program)
+{
+	//reloads always come from the GLSL source
+	m_Spirv = false;
+	//the old program goes after reflecting, its shadow holds the values to restore
+	unsigned int previous = m_RendererID;
+	m_RendererID = program;
+	ReflectProgram();
+	UploadQueuedUniforms();
+	if (previous != s_Placeholder)
+	{
+		GLState::OnDeleteProgram(previous);
+		GLCall(glDeleteProgram(previous));
+		UniformTable::ForgetProgram(previous);
+	}
+}
+
+void Shader::Reload()
+{
+	//an edit landing while the previous one still compiles replaces it
+	if (m_PendingProgram)
+		CancelPending();
+
+	ShaderProgramSource source;
+	if (!ShaderParser::Parse(m_FilePath, source))
+	{
+		std::cout << "Failed to reload " << m_FilePath << ", keeping the running program" << std::endl;
+		return;
+	}
+	InjectDefines(source, m_Defines, m_Separable);
+	//the edit may have added or removed includes
+	if (s_Watcher)
+		WatchFiles();
+
+	//pipelines have no async path, their stages compile right here
+	if (m_Separable)
+	{
+		unsigned int programs[ShaderStageCount] = {};
+		if (!GetStagePrograms(source, programs))
+		{
+			std::cout << "Failed to reload " << m_FilePath << ", keeping the running program" << std::endl;
+			return;
+		}
+		//the old stages go after reflecting, their shadows hold the values to restore; releasing
+		//them may delete the old pipeline
+		unsigned int previous[ShaderStageCount];
+		std::copy(m_StagePrograms, m_StagePrograms + ShaderStageCount, previous);
+		std::copy(programs, programs + ShaderStageCount, m_StagePrograms);
+		m_RendererID = ShaderPipeline::GetPipeline(m_StagePrograms);
+		ReflectProgram();
+		ReleaseStagePrograms(previous);
+		std::cout << "Reloaded " << m_FilePath << std::endl;
+		return;
+	}
+
+	//reverting an edit finds the old binary
+	unsigned int cached = ShaderCache::Load(ShaderCache::MakeKey(source), m_FilePath);
+	if (cached)
+	{
+		ReplaceProgram(cached);
+		std::cout << "Reloaded " << m_FilePath << std::endl;
+		return;
+	}
+
+	//the driver compiles on its own threads where it can (KHR_parallel_shader_compile),
+	//Poll() swaps the result in at the start of a later frame
+	SubmitAsync(source);
+}
+
+void Shader::WatchFiles()
+{
+	m_Dependencies = ShaderParser::GetDependencies(m_FilePath);
+	for (const std::string& file : m_Dependencies)
+		s_Watcher->Watch(file);
+}
+
+void Shader::EnableHotReload()
+{
+	if (s_Watcher)
+		return;
+	s_Watcher.reset(new FileWatcher());
+	for (Shader* shader : s_Shaders)
+		shader->WatchFiles();
+}
+
+void Shader::DisableHotReload()
+{
+	s_Watcher.reset();
+}
+
+bool Shader::Poll()
+{
+	if (!m_PendingProgram)
+		return true;
+
+	if (GLExtensions::HasParallelShaderCompile())
+	{
+		int done = GL_FALSE;
+		GLCall(glGetProgramiv(m_PendingProgram, GL_COMPLETION_STATUS_KHR, &done));
+		if (!done)
+			return false;
+	}
+
+	bool ok = true;
+	for (unsigned int stage : m_PendingStages)
+		ok = CheckShader(stage) && ok;
+	ok = ok && CheckProgram(m_PendingProgram);
+	for (unsigned int stage : m_PendingStages)
+	{
+		GLCall(glDeleteShader(stage));
+	}
+
+	unsigned int program = m_PendingProgram;
+	bool reload = m_RendererID != s_Placeholder;
+	m_PendingProgram = 0;
+	m_PendingStages.clear();
+	s_Pending.erase(std::remove(s_Pending.begin(), s_Pending.end(), this), s_Pending.end());
+
+	if (ok)
+	{
+		std::chrono::duration<double, std::milli> compileTime = std::chrono::high_resolution_clock::now() - m_CompileStart;
+		ShaderCache::Store(m_CacheKey, program, compileTime.count(), m_FilePath);
+		ReplaceProgram(program);
+		if (reload)
+			std::cout << "Reloaded " << m_FilePath << std::endl;
+		return true;
+	}
+
+	//keeps the placeholder so the failure stays visible on screen, or the old program after a reload
+	GLCall(glDeleteProgram(program));
+	if (reload)
+		std::cout << "Failed to reload " << m_FilePath << ", keeping the running program" << std::endl;
+	else
+		ReflectProgram();
+	m_QueuedUniforms.clear();
+	return true;
+}
+
+unsigned int Shader::PollAll()
+{
+	if (s_Watcher)
+	{
+		std::vector<std::string> changes = s_Watcher->TakeChanges();
+		for (const std::string& file : changes)
+			ShaderParser::Invalidate(file);
+		for (Shader* shader : s_Shaders)
+		{
+			for (const std::string& file : changes)
+			{
+				if (std::find(shader->m_Dependencies.begin(), shader->m_Dependencies.end(), file) != shader->m_Dependencies.end())
+				{
+					shader->Reload();
+					break;
+				}
+			}
+		}
+	}
+
+	//Poll() removes finished shaders from s_Pending, walk a copy
+	std::vector<Shader*> pending(s_Pending);
+	for (Shader* shader : pending)
+		shader->Poll();
+	return (unsigned int)s_Pending.size();
+}
+
+unsigned int Shader::GetPlaceholder()
+{
+	if (s_Placeholder)
+		return s_Placeholder;
+
+	//flat magenta, reads only the position at location 0 like every other program
+	static const char vertex[] =
+		"#version 330 core\n"
+		"layout(location = 0) in vec4 position;\n"
+		"void main() { gl_Position = vec4(position.xyz, 1.0); }\n";
+	static const char fragment[] =
+		"#version 330 core\n"
+		"layout(location = 0) out vec4 color;\n"
+		"void main() { color = vec4(1.0, 0.0, 1.0, 1.0); }\n";
+
+	unsigned int vs = CompileShader(GL_VERTEX_SHADER, { { vertex, (int)sizeof(vertex) - 1 } });
+	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, { { fragment, (int)sizeof(fragment) - 1 } });
+	GLCall(s_Placeholder = glCreateProgram());
+	GLCall(glAttachShader(s_Placeholder, vs));
+	GLCall(glAttachShader(s_Placeholder, fs));
+	GLCall(glLinkProgram(s_Placeholder));
+	GLCall(glDeleteShader(vs));
+	GLCall(glDeleteShader(fs));
+	return s_Placeholder;
 }
 
 void Shader::Bind() const
 {
-	GLCall(glUseProgram(m_RendererID));
+	if (m_Separable)
+	{
+		//a program bound with glUseProgram would take precedence over the pipeline
+		GLState::BindProgram(0);
+		GLState::BindProgramPipeline(m_RendererID);
+		return;
+	}
+	GLState::BindProgram(m_RendererID);
 }
 
 void Shader::UnBind() const
 {
-	GLCall(glUseProgram(0));
+	GLState::BindProgram(0);
+	if (m_Separable)
+		GLState::BindProgramPipeline(0);
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+void Shader::SetUniform4f(int handle, float v0, float v1, float v2, float v3)
 {
-	GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+	SetUniform(Uniform<Vec4>(handle), Vec4{ v0, v1, v2, v3 });
 }
 
-unsigned int Shader::GetUniformLocation(const std::string& name)
+bool Shader::ShouldUpload(int handle, const void* value, unsigned int size)
 {
-	if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-		return m_UniformLocationCache[name];
+	if (m_Uniforms.UpdateShadow(handle, value, size))
+	{
+		m_UploadStats.Uploaded++;
+		return true;
+	}
+	m_UploadStats.Elided++;
+	return false;
+}
+
+void Shader::SetUniform4f(const char* name, float v0, float v1, float v2, float v3)
+{
+	SetUniform4f(GetUniformHandle(name), v0, v1, v2, v3);
+}
 
-	GLCall(unsigned int location = glGetUniformLocation(m_RendererID, name.c_str()));
-	if (location == -1)
+void Shader::ReflectProgram()
+{
+	UniformTable previous(std::move(m_Uniforms));
+	if (m_Spirv)
+	{
+		m_Uniforms.Assign(m_RendererID, m_SpirvUniforms, m_SpirvBlocks, &previous);
+	}
+	else if (m_Separable)
+	{
+		std::vector<unsigned int> programs;
+		for (unsigned int program : m_StagePrograms)
+		{
+			if (program)
+				programs.push_back(program);
+		}
+		m_Uniforms.Reflect(programs.data(), (unsigned int)programs.size(), &previous);
+	}
+	else
+	{
+		m_Uniforms.Reflect(m_RendererID, &previous);
+	}
+	RestoreUniforms(previous);
+
+	//shared blocks go to the binding point their UniformBuffer claimed
+	for (const UniformBlockInfo& block : m_Uniforms.GetBlocks())
+	{
+		int binding = UniformBuffer::FindBinding(block.Name);
+		if (binding >= 0)
+		{
+			GLCall(glUniformBlockBinding(block.Program, block.Index, binding));
+		}
+	}
+}
+
+void Shader::RestoreUniforms(const UniformTable& previous)
+{
+	//a new program starts with every uniform at zero; values set once at startup would be lost
+	for (int handle = 0; handle < (int)previous.GetHandleCount(); handle++)
 	{
-		std::cout << "Warning uniform '" << " ' doesn't exist" << std::endl;
+		const void* value = previous.GetShadow(handle);
+		const UniformInfo& info = m_Uniforms.Get(handle);
+		const UniformInfo& old = previous.Get(handle);
+		if (!value || info.Location < 0 || info.Type != old.Type || info.Size != old.Size)
+			continue;
+
+		UploadData(handle, info.Type, info.Size, value);
+		m_Uniforms.UpdateShadow(handle, value, info.ShadowSize);
 	}
+}
 
-	m_UniformLocationCache[name] = location;
-	return location;
+void Shader::QueueUniform(int handle, unsigned int type, bool (*matches)(unsigned int), int count,
+	const void* value, unsigned int size)
+{
+	QueuedUniform& queued = m_QueuedUniforms[m_Uniforms.Get(handle).Hash];
+	queued.Type = type;
+	queued.Matches = matches;
+	queued.Count = count;
+	queued.Value.assign((const unsigned char*)value, (const unsigned char*)value + size);
 }
 
-ShaderProgramSource Shader::ParseShader(const std::string& filePath)
+void Shader::UploadQueuedUniforms()
 {
-	std::ifstream stream(filePath);
-	enum class ShaderType
+	for (const auto& entry : m_QueuedUniforms)
 	{
-		None = -1, VERTEX = 0, FRAGMENT = 1
-	};
+		const QueuedUniform& queued = entry.second;
+		//reserved handles carried over, ones the program does not have kept no location or type
+		int handle = m_Uniforms.Find(entry.first);
+		if (handle < 0)
+			continue;
+		const UniformInfo& info = m_Uniforms.Get(handle);
+		if (info.Type == 0)
+		{
+			std::cout << "Warning uniform '" << info.Name << "' (hash " << std::hex << info.Hash << std::dec
+				<< ") doesn't exist" << std::endl;
+			continue;
+		}
+		if (info.Location < 0)
+			continue;
+		if (!queued.Matches(info.Type))
+		{
+			WarnTypeMismatch(handle);
+			continue;
+		}
 
-	std::stringstream ss[2];
-	std::string line;
-	ShaderType type = ShaderType::None;
-	while (getline(stream, line))
+		int count = std::min(queued.Count, info.Size);
+		unsigned int size = (unsigned int)queued.Value.size() / queued.Count * count;
+		if (ShouldUpload(handle, queued.Value.data(), size))
+			UploadData(handle, queued.Type, count, queued.Value.data());
+	}
+	m_QueuedUniforms.clear();
+}
+
+void Shader::UploadData(int handle, unsigned int type, int count, const void* data) const
+{
+	//a Separable shader has one copy of the uniform per stage that declares it
+	for (; handle >= 0; handle = m_Uniforms.Get(handle).Next)
 	{
-		if (line.find("#shader") != std::string::npos)
+		const UniformInfo& info = m_Uniforms.Get(handle);
+		//handles of uniforms a reload removed are kept, with no location
+		if (info.Location < 0)
+			continue;
+
+		if (GLExtensions::HasProgramUniform())
 		{
-			if (line.find("vertex") != std::string::npos)
-				//set mode to vertex
-				type = ShaderType::VERTEX;
-			else if (line.find("fragment") != std::string::npos)
-				//set mode to fragment
-				type = ShaderType::FRAGMENT;
+			UploadProgramUniform(info.Program, info.Location, type, count, data);
 		}
 		else
 		{
-			ss[(int)type] << line << '\n';
+			GLState::BindProgram(m_RendererID);
+			UploadUniform(info.Location, type, count, data);
 		}
 	}
+}
+
+int Shader::GetUniformHandle(const char* name) const
+{
+	//the placeholder has none of our uniforms, the handle waits for the real program
+	if (!IsReady())
+		return m_Uniforms.Reserve(HashBytes(name, strlen(name)), name);
+
+	int handle = m_Uniforms.Find(name);
+	if (handle == -1)
+	{
+		std::cout << "Warning uniform '" << name << "' doesn't exist" << std::endl;
+	}
+	return handle;
+}
 
+int Shader::GetUniformHandle(UniformName name) const
+{
+	if (!IsReady())
+		return m_Uniforms.Reserve(name.Hash, nullptr);
 
-	return{ ss[0].str(), ss[1].str() };
+	int handle = m_Uniforms.Find(name.Hash);
+	if (handle == -1)
+	{
+		std::cout << "Warning uniform with hash " << std::hex << name.Hash << std::dec << " doesn't exist" << std::endl;
+	}
+	return handle;
+}
+
+void Shader::WarnTypeMismatch(int handle) const
+{
+	const UniformInfo& info = m_Uniforms.Get(handle);
+	std::cout << "Warning uniform '" << info.Name << "' has GL type 0x" << std::hex << info.Type << std::dec
+		<< ", which does not match the requested C++ type" << std::endl;
+}
+
+static bool Mentions(const std::vector<ShaderSourceSpan>& stage, const std::string& word)
+{
+	for (const ShaderSourceSpan& span : stage)
+	{
+		const char* end = span.Data + span.Length;
+		if (std::search(span.Data, end, word.begin(), word.end()) != end)
+			return true;
+	}
+	return false;
 }
 
+void Shader::InjectDefines(ShaderProgramSource& source, const std::vector<std::string>& defines, bool referencedOnly)
+{
+	if (defines.empty())
+		return;
+
+	//#version has to stay the first statement, so the defines go right after it.
+	//The span holding it is split in two around the block, the file text itself is never copied
+	static const char version[] = "#version";
+	for (std::vector<ShaderSourceSpan>& stage : source.Stages)
+	{
+		if (stage.empty())
+			continue;
+
+		std::string block;
+		for (const std::string& define : defines)
+		{
+			//"NAME" or "NAME value"
+			if (!referencedOnly || Mentions(stage, define.substr(0, define.find(' '))))
+				block += "#define " + define + "\n";
+		}
+		if (block.empty())
+			continue;
+		source.Storage.push_back(block);
+		ShaderSourceSpan blockSpan = { source.Storage.back().data(), (int)source.Storage.back().size() };
+
+		size_t at = 0;
+		for (size_t i = 0; i < stage.size(); i++)
+		{
+			const char* begin = stage[i].Data;
+			const char* end = begin + stage[i].Length;
+			const char* found = std::search(begin, end, version, version + sizeof(version) - 1);
+			if (found == end)
+				continue;
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+			const char* lineEnd = std::find(found, end, '\n');
+			const char* split = lineEnd == end ? end : lineEnd + 1;
+			ShaderSourceSpan head = { begin, (int)(split - begin) };
+			ShaderSourceSpan tail = { split, (int)(end - split) };
+			stage[i] = head;
+			at = i + 1;
+			if (tail.Length > 0)
+				stage.insert(stage.begin() + at, tail);
+			break;
+		}
+		stage.insert(stage.begin() + at, blockSpan);
+	}
+}
+
+unsigned int Shader::CreateShader(const ShaderProgramSource& source)
 {
 	unsigned int program = glCreateProgram();
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+	std::vector<unsigned int> stages;
+	for (unsigned int i = 0; i < ShaderStageCount; i++)
+	{
+		if (!source.HasStage((ShaderStage)i))
+			continue;
+		unsigned int id = CompileShader(GetShaderStageType((ShaderStage)i), source.Stages[i]);
+		glAttachShader(program, id);
+		stages.push_back(id);
+	}
 
-	glAttachShader(program, vs);
-	glAttachShader(program, fs);
+	//lets ShaderCache fetch the linked binary afterwards
+	if (ShaderCache::IsSupported())
+		GLExtensions::ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(program);
 	glValidateProgram(program);
 
-	glDeleteShader(vs);
-	glDeleteShader(fs);
+	for (unsigned int id : stages)
+		glDeleteShader(id);
+
+	return program;
+}
+
+unsigned int Shader::CreateSpirvProgram(const SpirvPack& pack)
+{
+	unsigned int program = glCreateProgram();
+	std::vector<unsigned int> stages;
+	bool ok = true;
+	for (const SpirvStage& stage : pack.Stages)
+	{
+		unsigned int id = glCreateShader(stage.Type);
+		GLCall(GLExtensions::ShaderBinary(1, &id, GL_SHADER_BINARY_FORMAT_SPIR_V, stage.Code.data(),
+			(int)(stage.Code.size() * sizeof(unsigned int))));
+		//no specialization constants, the .shader format has no way to set them
+		GLCall(GLExtensions::SpecializeShader(id, "main", 0, nullptr, nullptr));
+		ok = CheckShader(id) && ok;
+		glAttachShader(program, id);
+		stages.push_back(id);
+	}
 
+	glLinkProgram(program);
+	ok = ok && CheckProgram(program);
+	for (unsigned int id : stages)
+		glDeleteShader(id);
+
+	if (!ok)
+	{
+		std::cout << "Falling back to GLSL for " << m_FilePath << std::endl;
+		glDeleteProgram(program);
+		return 0;
+	}
 	return program;
 }
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
+bool Shader::GetStagePrograms(const ShaderProgramSource& source, unsigned int* programs)
+{
+	bool ok = true;
+	for (unsigned int i = 0; i < ShaderStageCount; i++)
+	{
+		if (!source.HasStage((ShaderStage)i))
+			continue;
+
+		unsigned long long key = ShaderPipeline::MakeStageKey((ShaderStage)i, source.Stages[i]);
+		programs[i] = ShaderPipeline::AcquireStageProgram(key);
+		if (programs[i] == 0)
+		{
+			programs[i] = CreateStageProgram((ShaderStage)i, source.Stages[i]);
+			if (programs[i])
+				ShaderPipeline::AddStageProgram(key, programs[i]);
+		}
+		ok = ok && programs[i] != 0;
+	}
+
+	//the shader never runs with a stage missing, the ones that did compile are not kept either
+	if (!ok)
+		ReleaseStagePrograms(programs);
+	return ok;
+}
+
+void Shader::ReleaseStagePrograms(unsigned int* programs)
+{
+	for (unsigned int i = 0; i < ShaderStageCount; i++)
+	{
+		if (programs[i])
+			ShaderPipeline::ReleaseStageProgram(programs[i]);
+		programs[i] = 0;
+	}
+}
+
+unsigned int Shader::CreateStageProgram(ShaderStage stage, const std::vector<ShaderSourceSpan>& source)
+{
+	//what glCreateShaderProgramv does, but that one only takes NUL terminated strings
+	unsigned int id = CompileShader(GetShaderStageType(stage), source);
+	if (!id)
+		return 0;
+
+	unsigned int program = glCreateProgram();
+	GLCall(GLExtensions::ProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE));
+	glAttachShader(program, id);
+	glLinkProgram(program);
+	glDetachShader(program, id);
+	glDeleteShader(id);
+
+	if (!CheckProgram(program))
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+unsigned int Shader::SubmitProgram(const std::vector<unsigned int>& stages)
+{
+	unsigned int program = glCreateProgram();
+	for (unsigned int id : stages)
+		glAttachShader(program, id);
+	if (ShaderCache::IsSupported())
+		GLExtensions::ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	//linking right away lets the driver chain it behind the compiles on its own threads
+	glLinkProgram(program);
+	return program;
+}
+
+unsigned int Shader::CompileShader(unsigned int type, const std::vector<ShaderSourceSpan>& source)
+{
+	unsigned int id = SubmitShader(type, source);
+	if (!CheckShader(id))
+	{
+		glDeleteShader(id);
+		return 0;
+	}
+
+	return id;
+}
+
+unsigned int Shader::SubmitShader(unsigned int type, const std::vector<ShaderSourceSpan>& source)
 {
 	unsigned int id = glCreateShader(type);
-	const char *src = source.c_str();
+	//every span goes in as its own string, straight out of the parsed chunk
+	std::vector<const char*> strings(source.size());
+	std::vector<int> lengths(source.size());
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		strings[i] = source[i].Data;
+		lengths[i] = source[i].Length;
+	}
 
-	glShaderSource(id, 1, &src, nullptr);
+	glShaderSource(id, (int)source.size(), strings.data(), lengths.data());
 	glCompileShader(id);
+	return id;
+}
 
+bool Shader::CheckShader(unsigned int id)
+{
 	//Error handling
 	int result;
 	glGetShaderiv(id, GL_COMPILE_STATUS, &result);
@@ -118,15 +754,39 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 	{
 		int length;
 		glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-		char* message = new char(length);
-		glGetShaderInfoLog(id, length, &length, message);
-		std::cout << "Failed to compile " <<
-			(type == GL_VERTEX_SHADER ? "vertex" : "fragment") << "shader!" << std::endl;
-		std::cout << message << std::endl;
-		glDeleteShader(id);
-		return 0;
+		std::vector<char> message(length + 1);
+		glGetShaderInfoLog(id, length, &length, message.data());
+		int type;
+		glGetShaderiv(id, GL_SHADER_TYPE, &type);
+		const char* name = "unknown";
+		for (unsigned int i = 0; i < ShaderStageCount; i++)
+		{
+			if (GetShaderStageType((ShaderStage)i) == (unsigned int)type)
+				name = GetShaderStageName((ShaderStage)i);
+		}
+		std::cout << "Failed to compile " << name << " shader!" << std::endl;
+		std::cout << message.data() << std::endl;
+		return false;
 	}
 
-	return id;
+	return true;
+}
+
+bool Shader::CheckProgram(unsigned int program)
+{
+	int result;
+	glGetProgramiv(program, GL_LINK_STATUS, &result);
+	if (result == GL_FALSE)
+	{
+		int length;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+		std::vector<char> message(length + 1);
+		glGetProgramInfoLog(program, length, &length, message.data());
+		std::cout << "Failed to link " << m_FilePath << "!" << std::endl;
+		std::cout << message.data() << std::endl;
+		return false;
+	}
+
+	return true;
 }
 
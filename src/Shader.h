@@ -1,35 +1,202 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
 #include <unordered_map>
 
-struct ShaderProgramSource
+#include "UniformTable.h"
+#include "Uniform.h"
+#include "ShaderParser.h"
+#include "ShaderCooker.h"
+
+struct UniformUploadStats
+{
+	unsigned int Uploaded;
+	//setter calls skipped because the value matched the last upload
+	unsigned int Elided;
+};
+
+enum class ShaderLoadMode
 {
-	std::string VertexSource;
-	std::string FragmentSource;
+	//compile, link and check before the constructor returns
+	Blocking,
+	//issue the compile and link and return, a placeholder program stands in until Poll() sees it finish
+	Async,
+	//link every stage on its own and bind them through a program pipeline, stages shared with other
+	//shaders are linked once (see ShaderPipeline); compiles block, falls back to Blocking below GL 4.1.
+	//Shaders sharing a stage share its uniform values too, set them before each draw
+	Separable
 };
 
 class Shader
 {
 private:
+	//the program pipeline for Separable shaders
 	unsigned int m_RendererID;
+	bool m_Separable;
+	//loaded from a cooked SPIR-V pack, whose uniforms GL cannot name
+	bool m_Spirv;
+	std::vector<UniformInfo> m_SpirvUniforms;
+	std::vector<SpirvBlock> m_SpirvBlocks;
+	unsigned int m_StagePrograms[ShaderStageCount];
 	std::string m_FilePath;
-	std::unordered_map<std::string, unsigned int> m_UniformLocationCache;
+	std::vector<std::string> m_Defines;
+	//mutable: resolving a handle while the placeholder stands in reserves it in the table
+	mutable UniformTable m_Uniforms;
+	UniformUploadStats m_UploadStats;
+
+	//a value set while the placeholder stands in, uploaded when the program is swapped in
+	struct QueuedUniform
+	{
+		unsigned int Type;
+		bool (*Matches)(unsigned int type);
+		int Count;
+		std::vector<unsigned char> Value;
+	};
+	//by name hash, the last value set wins
+	std::unordered_map<unsigned long long, QueuedUniform> m_QueuedUniforms;
+
+	//files the source was read from, for hot reload
+	std::vector<std::string> m_Dependencies;
+
+	//async compile (or reload) in flight, 0 once the program is ready
+	unsigned int m_PendingProgram;
+	std::vector<unsigned int> m_PendingStages;
+	unsigned long long m_CacheKey;
+	std::chrono::high_resolution_clock::time_point m_CompileStart;
+
+	static std::vector<Shader*> s_Pending;
+	static std::vector<Shader*> s_Shaders;
+	static unsigned int s_Placeholder;
 
 public:
-	Shader(const std::string& filepath);
+	Shader(const std::string& filepath, ShaderLoadMode mode = ShaderLoadMode::Blocking);
+	//each define is emitted as "#define <define>" right after the #version line of every stage
+	Shader(const std::string& filepath, const std::vector<std::string>& defines,
+		ShaderLoadMode mode = ShaderLoadMode::Blocking);
 	~Shader();
 
+	//false only while the placeholder stands in, a reload keeps the old program running meanwhile
+	inline bool IsReady() const { return m_PendingProgram == 0 || m_RendererID != s_Placeholder; }
+	//finishes the async compile if the driver is done with it; only stalls when
+	//KHR_parallel_shader_compile is missing and GL cannot say without blocking
+	bool Poll();
+	//polls every pending shader and starts reloads for edited files, call once per frame
+	//(a frame boundary); returns how many are still compiling
+	static unsigned int PollAll();
+
+	//re-parses the file and compiles it again; the new program replaces the running one when it
+	//is done, and a failed compile keeps the running one. Uniform handles stay valid
+	void Reload();
+	//watches the files of every shader (and their includes) from a background thread,
+	//PollAll() reloads the shaders whose files changed
+	static void EnableHotReload();
+	static void DisableHotReload();
+
 	void Bind() const;
 	void UnBind() const;
 
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline bool IsSeparable() const { return m_Separable; }
+
+	//uniform handles index the reflected table; resolve them once and reuse them, -1 means the
+	//program has no such uniform and setting it is a no-op. While the placeholder stands in every
+	//name gets a handle and the values set through it are queued, then uploaded when the program
+	//is swapped in; only then does a missing uniform or a type mismatch show up
+	int GetUniformHandle(const char* name) const;
+	int GetUniformHandle(UniformName name) const;
+	inline const UniformTable& GetUniforms() const { return m_Uniforms; }
+	inline const UniformUploadStats& GetUploadStats() const { return m_UploadStats; }
+	inline void ResetUploadStats() { m_UploadStats = { 0, 0 }; }
+
 	//set uniforms
-	void SetUniform4f(const std::string& name, float v0, float v1, float f2, float f3);
+	void SetUniform4f(int handle, float v0, float v1, float v2, float v3);
+	void SetUniform4f(const char* name, float v0, float v1, float f2, float f3);
+
+	//typed handle, invalid when the uniform is missing or its GLSL type does not match T
+	template<typename T>
+	Uniform<T> GetUniform(UniformName name) const
+	{
+		int handle = GetUniformHandle(name);
+		if (handle >= 0 && IsReady() && !UniformTraits<T>::Matches(m_Uniforms.Get(handle).Type))
+		{
+			WarnTypeMismatch(handle);
+			handle = -1;
+		}
+		return Uniform<T>(handle);
+	}
+
+	//the shader need not be bound: GL 4.1+ writes straight into the program with glProgramUniform*,
+	//below that the setter binds the program itself
+	template<typename T>
+	void SetUniform(Uniform<T> uniform, const T& value)
+	{
+		if (!uniform.IsValid())
+			return;
+		if (!IsReady())
+			QueueUniform(uniform.Handle, UniformTraits<T>::Type, &UniformTraits<T>::Matches, 1, &value, sizeof(T));
+		else if (ShouldUpload(uniform.Handle, &value, sizeof(T)))
+			UploadData(uniform.Handle, UniformTraits<T>::Type, 1, &value);
+	}
+
+	//the first count elements of an array uniform, elements past its size are dropped
+	template<typename T>
+	void SetUniform(Uniform<T> uniform, const T* values, int count)
+	{
+		if (!uniform.IsValid() || count <= 0)
+			return;
+		//the size is not known before the program is, the queue clamps once it is
+		if (!IsReady())
+		{
+			QueueUniform(uniform.Handle, UniformTraits<T>::Type, &UniformTraits<T>::Matches, count, values, sizeof(T) * count);
+			return;
+		}
+		count = std::min(count, m_Uniforms.Get(uniform.Handle).Size);
+		if (ShouldUpload(uniform.Handle, values, sizeof(T) * count))
+			UploadData(uniform.Handle, UniformTraits<T>::Type, count, values);
+	}
+
+	//skips the value shadow, only for uniforms that never go through SetUniform (e.g. u_DrawID)
+	template<typename T>
+	void Upload(Uniform<T> uniform, const T& value) const
+	{
+		if (uniform.IsValid())
+			UploadData(uniform.Handle, UniformTraits<T>::Type, 1, &value);
+	}
 
 private:
-	ShaderProgramSource Shader::ParseShader(const std::string& filePath);
-	unsigned int CompileShader(unsigned int type, const std::string& source);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	unsigned int GetUniformLocation(const std::string& name);
+	//referencedOnly leaves out defines a stage never mentions, so the stage source (and its
+	//separable program) stays the same across permutations that only touch other stages
+	static void InjectDefines(ShaderProgramSource& source, const std::vector<std::string>& defines, bool referencedOnly);
+	static unsigned int CompileShader(unsigned int type, const std::vector<ShaderSourceSpan>& source);
+	static unsigned int SubmitShader(unsigned int type, const std::vector<ShaderSourceSpan>& source);
+	static bool CheckShader(unsigned int id);
+	bool CheckProgram(unsigned int program);
+	unsigned int CreateShader(const ShaderProgramSource& source);
+	//0 when any stage is rejected
+	unsigned int CreateSpirvProgram(const SpirvPack& pack);
+	unsigned int CreateStageProgram(ShaderStage stage, const std::vector<ShaderSourceSpan>& source);
+	//fills programs[stage] from ShaderPipeline's cache or compiles it, holding a reference to each;
+	//false if a stage failed, no references are held then
+	bool GetStagePrograms(const ShaderProgramSource& source, unsigned int* programs);
+	static void ReleaseStagePrograms(unsigned int* programs);
+	void SubmitAsync(const ShaderProgramSource& source);
+	void CancelPending();
+	void ReplaceProgram(unsigned int program);
+	void WatchFiles();
+	static unsigned int SubmitProgram(const std::vector<unsigned int>& stages);
+	static unsigned int GetPlaceholder();
+	void WarnTypeMismatch(int handle) const;
+	//fills the uniform table and links uniform blocks to their registered binding points; handles
+	//and uniform values carry over from the previous program
+	void ReflectProgram();
+	void RestoreUniforms(const UniformTable& previous);
+	void QueueUniform(int handle, unsigned int type, bool (*matches)(unsigned int), int count, const void* value, unsigned int size);
+	//after ReflectProgram on the program replacing the placeholder
+	void UploadQueuedUniforms();
+	void UploadData(int handle, unsigned int type, int count, const void* data) const;
+	bool ShouldUpload(int handle, const void* value, unsigned int size);
 
 };
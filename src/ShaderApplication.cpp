@@ -7,11 +7,24 @@
 #include "VertexArray.h"
 #include "Shader.h"
 #include "VertexBufferLayout.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+#include "Profiler.h"
+#include "Framebuffer.h"
+#include "FrameStats.h"
+#include "Benchmark.h"
+#include "ShaderPipeline.h"
+#include "ShaderCooker.h"
 
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <chrono>
+#include <memory>
 
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -20,18 +33,88 @@ void processInput(GLFWwindow* window);
 //settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
+//FrameStats reserves a sample per frame up front
+const unsigned int MAX_FRAMES = 1000000;
 
-int main()
+int main(int argc, char** argv)
 {
+	//--headless renders a fixed number of frames offscreen without vsync and prints timings as JSON,
+	//--osmesa asks GLFW for a Mesa software context for machines without a GPU; that needs a GLFW
+	//built with OSMesa, and glfwInit still needs a display. The project only builds for Windows
+	//against the bundled vc2015 GLFW, there is no Linux build for CPU-only servers
+	//--bench runs the throughput scenarios headless and compares them with --baseline,
+	//exiting with 1 on a regression; --write-baseline records the run as the new baseline
+	//--hot-reload recompiles shaders whose files change while the application runs,
+	//--cook <file.shader> compiles it to a SPIR-V pack for GL_ARB_gl_spirv and exits (may repeat)
+	//--trace <file.json> writes the profiler's zones as a chrome://tracing file on exit
+	bool headless = false;
+	bool hotReload = false;
+	std::vector<std::string> cook;
+	bool osmesa = false;
+	bool bench = false;
+	bool writeBaseline = false;
+	std::string baselinePath = "res/benchmarks/baseline.txt";
+	std::string tracePath;
+	unsigned int frameCount = 1000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--headless") == 0)
+			headless = true;
+		else if (strcmp(argv[i], "--bench") == 0)
+			bench = headless = true;
+		else if (strcmp(argv[i], "--write-baseline") == 0)
+			writeBaseline = true;
+		else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+			baselinePath = argv[++i];
+		else if (strcmp(argv[i], "--cook") == 0 && i + 1 < argc)
+			cook.push_back(argv[++i]);
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			tracePath = argv[++i];
+		else if (strcmp(argv[i], "--hot-reload") == 0)
+			hotReload = true;
+		else if (strcmp(argv[i], "--osmesa") == 0)
+			osmesa = true;
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			//strtoul would take "-1" as a huge count and "abc" as 0, only plain digits in range pass
+			const char* value = argv[++i];
+			char* end = nullptr;
+			unsigned long frames = strtoul(value, &end, 10);
+			if (!isdigit((unsigned char)value[0]) || *end != '\0' || frames == 0 || frames > MAX_FRAMES)
+			{
+				std::cerr << "usage: --frames <count>, count from 1 to " << MAX_FRAMES << ", got \"" << value << "\"" << std::endl;
+				return 1;
+			}
+			frameCount = (unsigned int)frames;
+		}
+	}
+
+	//cooking needs no context, and a failure fails the build step running it
+	if (!cook.empty())
+	{
+		bool ok = true;
+		for (const std::string& file : cook)
+			ok = ShaderCooker::Cook(file) && ok;
+		return ok ? 0 : 1;
+	}
+
 	//glfw initialize and configure
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if GLCALL_MODE != GLCALL_MODE_OFF
+	//debug contexts are the only ones guaranteed to emit KHR_debug messages
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#endif
 
 #ifdef __APPLE__
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+	if (headless)
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	if (osmesa)
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
 
 	//glfw window creation
 	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
@@ -46,7 +129,7 @@ int main()
 	glfwMakeContextCurrent(window);
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-	glfwSwapInterval(1);
+	glfwSwapInterval(headless ? 0 : 1);
 
 	//glad: load all OpenGL function pointers
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -55,6 +138,31 @@ int main()
 		std::cin.get();
 		return -1;
 	}
+	GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+	GLDebug::Init();
+	Profiler::Init();
+	if (bench)
+	{
+		int exitCode = 0;
+		{
+			Benchmark benchmark(frameCount);
+			benchmark.RunAll();
+			std::cout << benchmark.ToJson() << std::endl;
+			if (writeBaseline)
+			{
+				if (!benchmark.WriteBaseline(baselinePath))
+				{
+					std::cerr << "[Benchmark] ERROR: cannot write baseline " << baselinePath << std::endl;
+					exitCode = 1;
+				}
+			}
+			else if (benchmark.CompareBaseline(baselinePath, 0.25) > 0)
+				exitCode = 1;
+		}
+		Profiler::Shutdown();
+		glfwTerminate();
+		return exitCode;
+	}
 	{
 		float verticesTR[] = {
 			-0.9f, -0.5f, 0.0f,  // left 
@@ -81,28 +189,43 @@ int main()
 		va.AddBuffer(vb, layout);
 
 		//shader
+		if (hotReload)
+			Shader::EnableHotReload();
 		Shader shader("res\\shaders\\Basic.shader");
-		shader.Bind();
-		shader.SetUniform4f("u_Color", 0.5f, 0.3f, 0.8f, 1.0f);
-		shader.UnBind();
+		static constexpr UniformName ColorName = "u_Color"_u;
+		Uniform<Vec4> colorUniform = shader.GetUniform<Vec4>(ColorName);
+		shader.SetUniform(colorUniform, Vec4{ 0.5f, 0.3f, 0.8f, 1.0f });
 
 		va.UnBind();
 		vb.UnBind();
 		ib.UnBind();
 
+		//the hidden window's default framebuffer may not be backed by anything
+		std::unique_ptr<Framebuffer> target;
+		if (headless)
+		{
+			target.reset(new Framebuffer(SCR_WIDTH, SCR_HEIGHT));
+			if (!target->IsComplete())
+				std::cout << "Offscreen framebuffer is incomplete" << std::endl;
+		}
+		FrameStats frameStats;
+		frameStats.Reserve(frameCount);
+
 		Render renderer;
 		float r = 0.0f;
 		float increment = 0.05f;
 		//render loop
-		while (!glfwWindowShouldClose(window))
+		while (headless ? frameStats.GetFrameCount() < frameCount : !glfwWindowShouldClose(window))
 		{
+			auto frameStart = std::chrono::high_resolution_clock::now();
+			Profiler::BeginFrame();
+
 			//keyboard input 
 			processInput(window);
 
 			renderer.Clear();
 
-			shader.Bind();
-			shader.SetUniform4f("u_Color", r, 0.3f, 0.8f, 1.0f);
+			shader.SetUniform(colorUniform, Vec4{ r, 0.3f, 0.8f, 1.0f });
 
 			renderer.Draw(va, ib, shader);
 
@@ -111,10 +234,33 @@ int main()
 			else if (r < 0.0f)
 				increment = 0.05f;
 			r += increment;		
+
+			//close this frame's redundant-bind counters
+			GLState::NewFrame();
+			Shader::PollAll();
+			GLDebug::FlushMessages();
 			//glfw: swap buffers and poll IO events(keys pressed/released, mouse moved etc.)
-			glfwSwapBuffers(window);
+			if (headless)
+			{
+				//no swap to pace us, wait for the GPU so the frame time covers its work
+				GLCall(glFinish());
+			}
+			else
+				glfwSwapBuffers(window);
 			glfwPollEvents();
+
+			Profiler::EndFrame();
+			std::chrono::duration<double, std::milli> frameTime = std::chrono::high_resolution_clock::now() - frameStart;
+			frameStats.AddFrame(frameTime.count(), renderer.GetStats());
+			renderer.ResetStats();
 		}
+		if (headless)
+			std::cout << frameStats.ToJson("ShaderApplication") << std::endl;
+		Profiler::Shutdown();
+		if (!tracePath.empty() && !Profiler::WriteChromeTrace(tracePath))
+			std::cerr << "[Profiler] cannot write " << tracePath << std::endl;
+		Shader::DisableHotReload();
+		ShaderPipeline::Clear();
 		//delete 
 		//~
 	}
@@ -0,0 +1,165 @@
+#include "ShaderCache.h"
+#include "Shader.h"
+#include "Render.h"
+#include "GLExtensions.h"
+#include "Hash.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define MakeDirectory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define MakeDirectory(path) mkdir(path, 0755)
+#endif
+
+std::string ShaderCache::s_Directory = "shadercache";
+unsigned int ShaderCache::s_Hits = 0;
+unsigned int ShaderCache::s_Misses = 0;
+double ShaderCache::s_SavedMs = 0.0;
+
+static const unsigned int CacheMagic = 0x42504C47; // "GLPB"
+static const unsigned int CacheVersion = 1;
+
+struct CacheHeader
+{
+	unsigned int Magic;
+	unsigned int Version;
+	unsigned int BinaryFormat;
+	unsigned int Length;
+	double CompileMs;
+};
+
+bool ShaderCache::IsSupported()
+{
+	if (!GLExtensions::HasProgramBinary())
+		return false;
+
+	//drivers may expose the entry points but support no binary format at all
+	int formats = 0;
+	GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+	return formats > 0;
+}
+
+unsigned long long ShaderCache::MakeKey(const ShaderProgramSource& source)
+{
+	unsigned long long hash = FnvOffsetBasis;
+	GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	for (GLenum name : strings)
+	{
+		GLCall(const char* value = (const char*)glGetString(name));
+		if (value)
+			hash = HashString(value, hash);
+	}
+	//per stage length prefixes keep "ab"+"c" and "a"+"bc" apart, spans are hashed back to back
+	for (const std::vector<ShaderSourceSpan>& stage : source.Stages)
+	{
+		size_t stageSize = 0;
+		for (const ShaderSourceSpan& span : stage)
+			stageSize += span.Length;
+		hash = HashBytes(&stageSize, sizeof(stageSize), hash);
+		for (const ShaderSourceSpan& span : stage)
+			hash = HashBytes(span.Data, span.Length, hash);
+	}
+	return hash;
+}
+
+std::string ShaderCache::GetPath(unsigned long long key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", key);
+	return s_Directory + "/" + name;
+}
+
+unsigned int ShaderCache::Load(unsigned long long key, const std::string& name)
+{
+	if (!IsSupported())
+		return 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	std::string path = GetPath(key);
+	std::ifstream stream(path, std::ios::binary);
+	CacheHeader header;
+	if (!stream || !stream.read((char*)&header, sizeof(header))
+		|| header.Magic != CacheMagic || header.Version != CacheVersion)
+	{
+		s_Misses++;
+		std::cout << "[ShaderCache] miss " << name << std::endl;
+		return 0;
+	}
+
+	//a corrupt length must not turn into a huge allocation, it has to fit in what is left of the file
+	std::streamoff dataStart = stream.tellg();
+	stream.seekg(0, std::ios::end);
+	std::streamoff remaining = stream.tellg() - dataStart;
+	stream.seekg(dataStart);
+	if (remaining < 0 || (unsigned long long)header.Length > (unsigned long long)remaining)
+	{
+		s_Misses++;
+		std::cout << "[ShaderCache] truncated entry for " << name << std::endl;
+		return 0;
+	}
+
+	std::vector<char> binary(header.Length);
+	if (!stream.read(binary.data(), header.Length))
+	{
+		s_Misses++;
+		std::cout << "[ShaderCache] truncated entry for " << name << std::endl;
+		return 0;
+	}
+
+	GLCall(unsigned int program = glCreateProgram());
+	GLCall(GLExtensions::ProgramBinary(program, header.BinaryFormat, binary.data(), header.Length));
+	int linked = GL_FALSE;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	if (linked == GL_FALSE)
+	{
+		//a driver update can reject binaries from the same version string, drop the entry
+		GLCall(glDeleteProgram(program));
+		stream.close();
+		remove(path.c_str());
+		s_Misses++;
+		std::cout << "[ShaderCache] driver rejected binary for " << name << ", recompiling" << std::endl;
+		return 0;
+	}
+
+	std::chrono::duration<double, std::milli> loadTime = std::chrono::high_resolution_clock::now() - start;
+	double saved = header.CompileMs - loadTime.count();
+	s_Hits++;
+	s_SavedMs += saved;
+	std::cout << "[ShaderCache] hit " << name << ", saved " << saved << " ms" << std::endl;
+	return program;
+}
+
+void ShaderCache::Store(unsigned long long key, unsigned int program, double compileMs, const std::string& name)
+{
+	if (!IsSupported())
+		return;
+
+	int linked = GL_FALSE;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	int length = 0;
+	GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+	if (linked == GL_FALSE || length <= 0)
+		return;
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	GLCall(GLExtensions::GetProgramBinary(program, length, &length, &format, binary.data()));
+
+	MakeDirectory(s_Directory.c_str());
+	std::ofstream stream(GetPath(key), std::ios::binary);
+	if (!stream)
+	{
+		std::cout << "[ShaderCache] could not write entry for " << name << std::endl;
+		return;
+	}
+	CacheHeader header = { CacheMagic, CacheVersion, format, (unsigned int)length, compileMs };
+	stream.write((const char*)&header, sizeof(header));
+	stream.write(binary.data(), length);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+struct ShaderProgramSource;
+
+// Disk cache of linked program binaries (glGetProgramBinary). Entries are keyed
+// by the program source and the GL vendor/renderer/version, so a driver update
+// misses instead of feeding the driver a binary it no longer understands; a
+// binary the driver rejects anyway is deleted and the caller recompiles.
+class ShaderCache
+{
+public:
+	static void SetDirectory(const std::string& directory) { s_Directory = directory; }
+	static bool IsSupported();
+
+	static unsigned long long MakeKey(const ShaderProgramSource& source);
+
+	//linked program from the cache, 0 on a miss or when the driver rejects the binary
+	static unsigned int Load(unsigned long long key, const std::string& name);
+	//program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+	static void Store(unsigned long long key, unsigned int program, double compileMs, const std::string& name);
+
+	static inline unsigned int GetHits() { return s_Hits; }
+	static inline unsigned int GetMisses() { return s_Misses; }
+	static inline double GetSavedMs() { return s_SavedMs; }
+
+private:
+	static std::string GetPath(unsigned long long key);
+
+	static std::string s_Directory;
+	static unsigned int s_Hits;
+	static unsigned int s_Misses;
+	static double s_SavedMs;
+};
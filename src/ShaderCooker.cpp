@@ -0,0 +1,430 @@
+#include "ShaderCooker.h"
+#include "Hash.h"
+
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+static const unsigned int PackMagic = 0x56535047; // "GPSV"
+static const unsigned int PackVersion = 2;
+
+struct PackHeader
+{
+	unsigned int Magic;
+	unsigned int Version;
+	unsigned long long SourceKey;
+	unsigned int StageCount;
+	unsigned int UniformCount;
+	unsigned int BlockCount;
+};
+
+//glslangValidator's -S names, in ShaderStage order
+static const char* s_StageSuffixes[ShaderStageCount] = { "vert", "frag", "geom", "tesc", "tese", "comp" };
+
+unsigned long long ShaderCooker::MakeSourceKey(const ShaderProgramSource& source)
+{
+	unsigned long long hash = FnvOffsetBasis;
+	for (const std::vector<ShaderSourceSpan>& stage : source.Stages)
+	{
+		size_t stageSize = 0;
+		for (const ShaderSourceSpan& span : stage)
+			stageSize += span.Length;
+		hash = HashBytes(&stageSize, sizeof(stageSize), hash);
+		for (const ShaderSourceSpan& span : stage)
+			hash = HashBytes(span.Data, span.Length, hash);
+	}
+	return hash;
+}
+
+bool ShaderCooker::Cook(const std::string& filePath, const std::string& compiler)
+{
+	ShaderProgramSource source;
+	if (!ShaderParser::Parse(filePath, source))
+	{
+		std::cout << "[ShaderCooker] cannot parse " << filePath << std::endl;
+		return false;
+	}
+
+	SpirvPack pack;
+	pack.SourceKey = MakeSourceKey(source);
+	bool ok = true;
+	for (unsigned int i = 0; i < ShaderStageCount; i++)
+	{
+		if (!source.HasStage((ShaderStage)i))
+			continue;
+
+		SpirvStage stage = { GetShaderStageType((ShaderStage)i), std::vector<unsigned int>() };
+		if (!CompileStage((ShaderStage)i, source.Stages[i], compiler, filePath + "." + s_StageSuffixes[i], stage.Code))
+		{
+			std::cout << "[ShaderCooker] " << filePath << ": " << GetShaderStageName((ShaderStage)i)
+				<< " stage failed to compile" << std::endl;
+			ok = false;
+			continue;
+		}
+		ReflectUniforms(stage.Code, pack.Uniforms, pack.Blocks);
+		pack.Stages.push_back(std::move(stage));
+	}
+	if (!ok || pack.Stages.empty())
+		return false;
+
+	std::string packPath = GetPackPath(filePath);
+	std::ofstream stream(packPath, std::ios::binary);
+	PackHeader header = { PackMagic, PackVersion, pack.SourceKey,
+		(unsigned int)pack.Stages.size(), (unsigned int)pack.Uniforms.size(), (unsigned int)pack.Blocks.size() };
+	stream.write((const char*)&header, sizeof(header));
+	for (const SpirvStage& stage : pack.Stages)
+	{
+		unsigned int words = (unsigned int)stage.Code.size();
+		stream.write((const char*)&stage.Type, sizeof(stage.Type));
+		stream.write((const char*)&words, sizeof(words));
+		stream.write((const char*)stage.Code.data(), words * sizeof(unsigned int));
+	}
+	for (const UniformInfo& uniform : pack.Uniforms)
+	{
+		unsigned int nameLength = (unsigned int)uniform.Name.size();
+		stream.write((const char*)&uniform.Location, sizeof(uniform.Location));
+		stream.write((const char*)&uniform.Type, sizeof(uniform.Type));
+		stream.write((const char*)&uniform.Size, sizeof(uniform.Size));
+		stream.write((const char*)&nameLength, sizeof(nameLength));
+		stream.write(uniform.Name.data(), nameLength);
+	}
+	for (const SpirvBlock& block : pack.Blocks)
+	{
+		unsigned int nameLength = (unsigned int)block.Name.size();
+		stream.write((const char*)&block.Binding, sizeof(block.Binding));
+		stream.write((const char*)&nameLength, sizeof(nameLength));
+		stream.write(block.Name.data(), nameLength);
+	}
+	if (!stream)
+	{
+		std::cout << "[ShaderCooker] cannot write " << packPath << std::endl;
+		return false;
+	}
+
+	std::cout << "[ShaderCooker] " << filePath << " -> " << packPath << ", " << pack.Stages.size()
+		<< " stages, " << pack.Uniforms.size() << " uniforms, " << pack.Blocks.size() << " blocks" << std::endl;
+	return true;
+}
+
+bool ShaderCooker::CompileStage(ShaderStage stage, const std::vector<ShaderSourceSpan>& source,
+	const std::string& compiler, const std::string& tempPath, std::vector<unsigned int>& code)
+{
+	//glslangValidator only reads files, hand it the stage as the parser put it together
+	std::string glslPath = tempPath + ".glsl";
+	std::string spirvPath = tempPath + ".spvtmp";
+	{
+		std::ofstream glsl(glslPath, std::ios::binary);
+		for (const ShaderSourceSpan& span : source)
+			glsl.write(span.Data, span.Length);
+	}
+
+	//-G targets OpenGL rather than Vulkan; loose uniforms need explicit locations in
+	//SPIR-V for GL, the auto-map flags assign them so the .shader files stay unchanged
+	std::string command = "\"" + compiler + "\" -G --auto-map-locations --auto-map-bindings -S "
+		+ s_StageSuffixes[(int)stage] + " -o \"" + spirvPath + "\" \"" + glslPath + "\"";
+#ifdef _WIN32
+	//cmd /c drops the first and the last quote of a command that starts with one
+	command = "\"" + command + "\"";
+#endif
+	int result = std::system(command.c_str());
+	remove(glslPath.c_str());
+	if (result != 0)
+	{
+		remove(spirvPath.c_str());
+		return false;
+	}
+
+	std::ifstream spirv(spirvPath, std::ios::binary | std::ios::ate);
+	std::streamoff size = spirv.tellg();
+	spirv.seekg(0);
+	code.resize((size_t)size / sizeof(unsigned int));
+	bool read = size > 0 && spirv.read((char*)code.data(), code.size() * sizeof(unsigned int));
+	spirv.close();
+	remove(spirvPath.c_str());
+	return read;
+}
+
+//just enough of SPIR-V to find loose uniforms, their names, locations and the type GL would report,
+//and uniform blocks with their names and bindings
+namespace Spirv
+{
+	enum Op
+	{
+		OpName = 5, OpTypeBool = 20, OpTypeInt = 21, OpTypeFloat = 22, OpTypeVector = 23, OpTypeMatrix = 24,
+		OpTypeImage = 25, OpTypeSampledImage = 27, OpTypeArray = 28, OpTypeStruct = 30, OpTypePointer = 32,
+		OpConstant = 43, OpVariable = 59, OpDecorate = 71
+	};
+	const unsigned int DecorationBlock = 2;
+	const unsigned int DecorationLocation = 30;
+	const unsigned int DecorationBinding = 33;
+	const unsigned int StorageClassUniformConstant = 0;
+	const unsigned int StorageClassUniform = 2;
+	const unsigned int HeaderWords = 5;
+
+	typedef std::unordered_map<unsigned int, std::vector<unsigned int>> TypeMap;
+
+	unsigned int GetGLType(unsigned int id, const TypeMap& types)
+	{
+		auto found = types.find(id);
+		if (found == types.end())
+			return 0;
+
+		const std::vector<unsigned int>& w = found->second;
+		switch (w[0] & 0xFFFF)
+		{
+		case OpTypeBool:
+			return GL_BOOL;
+		case OpTypeInt:
+			return w[3] ? GL_INT : GL_UNSIGNED_INT;
+		case OpTypeFloat:
+			return w[2] == 32 ? GL_FLOAT : 0;
+		case OpTypeVector:
+		{
+			static const unsigned int floats[] = { GL_FLOAT_VEC2, GL_FLOAT_VEC3, GL_FLOAT_VEC4 };
+			static const unsigned int ints[] = { GL_INT_VEC2, GL_INT_VEC3, GL_INT_VEC4 };
+			static const unsigned int uints[] = { GL_UNSIGNED_INT_VEC2, GL_UNSIGNED_INT_VEC3, GL_UNSIGNED_INT_VEC4 };
+			static const unsigned int bools[] = { GL_BOOL_VEC2, GL_BOOL_VEC3, GL_BOOL_VEC4 };
+			unsigned int component = GetGLType(w[2], types);
+			unsigned int count = w[3];
+			if (count < 2 || count > 4)
+				return 0;
+			switch (component)
+			{
+			case GL_FLOAT:        return floats[count - 2];
+			case GL_INT:          return ints[count - 2];
+			case GL_UNSIGNED_INT: return uints[count - 2];
+			case GL_BOOL:         return bools[count - 2];
+			}
+			return 0;
+		}
+		case OpTypeMatrix:
+		{
+			//only the square float matrices UniformTable knows about
+			unsigned int column = GetGLType(w[2], types);
+			unsigned int columns = w[3];
+			if (column == GL_FLOAT_VEC2 && columns == 2) return GL_FLOAT_MAT2;
+			if (column == GL_FLOAT_VEC3 && columns == 3) return GL_FLOAT_MAT3;
+			if (column == GL_FLOAT_VEC4 && columns == 4) return GL_FLOAT_MAT4;
+			return 0;
+		}
+		case OpTypeSampledImage:
+		{
+			auto image = types.find(w[2]);
+			if (image == types.end())
+				return 0;
+			//OpTypeImage: result, sampled type, Dim, Depth, Arrayed, ...
+			unsigned int dim = image->second[3];
+			bool depth = image->second[4] == 1;
+			bool arrayed = image->second[5] == 1;
+			if (dim == 1)
+				return depth ? GL_SAMPLER_2D_SHADOW : arrayed ? GL_SAMPLER_2D_ARRAY : GL_SAMPLER_2D;
+			if (dim == 2)
+				return GL_SAMPLER_3D;
+			if (dim == 3)
+				return GL_SAMPLER_CUBE;
+			return 0;
+		}
+		}
+		return 0;
+	}
+}
+
+void ShaderCooker::ReflectUniforms(const std::vector<unsigned int>& code, std::vector<UniformInfo>& uniforms,
+	std::vector<SpirvBlock>& blocks)
+{
+	using namespace Spirv;
+
+	std::unordered_map<unsigned int, std::string> names;
+	std::unordered_map<unsigned int, int> locations;
+	std::unordered_map<unsigned int, unsigned int> bindings;
+	std::unordered_map<unsigned int, bool> blockTypes;
+	std::unordered_map<unsigned int, unsigned int> constants;
+	TypeMap types;
+	//pointer type and id of every UniformConstant variable, and of every Uniform one
+	std::vector<std::pair<unsigned int, unsigned int>> variables;
+	std::vector<std::pair<unsigned int, unsigned int>> blockVariables;
+
+	for (size_t i = HeaderWords; i < code.size(); )
+	{
+		unsigned int count = code[i] >> 16;
+		unsigned int op = code[i] & 0xFFFF;
+		if (count == 0 || i + count > code.size())
+			break;
+
+		const unsigned int* w = &code[i];
+		if (op == OpName && count > 2)
+			names[w[1]] = std::string((const char*)&w[2]);
+		else if (op == OpDecorate && count > 3 && w[2] == DecorationLocation)
+			locations[w[1]] = (int)w[3];
+		else if (op == OpDecorate && count > 3 && w[2] == DecorationBinding)
+			bindings[w[1]] = w[3];
+		else if (op == OpDecorate && count > 2 && w[2] == DecorationBlock)
+			blockTypes[w[1]] = true;
+		else if (op == OpConstant && count > 3)
+			constants[w[2]] = w[3];
+		else if (op == OpVariable && count > 3 && w[3] == StorageClassUniformConstant)
+			variables.push_back(std::make_pair(w[1], w[2]));
+		else if (op == OpVariable && count > 3 && w[3] == StorageClassUniform)
+			blockVariables.push_back(std::make_pair(w[1], w[2]));
+		else if (op >= OpTypeBool && op <= OpTypePointer)
+			types[w[1]] = std::vector<unsigned int>(w, w + count);
+		i += count;
+	}
+
+	for (const auto& variable : variables)
+	{
+		auto pointer = types.find(variable.first);
+		auto location = locations.find(variable.second);
+		auto name = names.find(variable.second);
+		if (pointer == types.end() || location == locations.end() || name == names.end() || name->second.empty())
+			continue;
+
+		//OpTypePointer: result, storage class, pointee
+		unsigned int type = pointer->second[3];
+		int size = 1;
+		auto array = types.find(type);
+		if (array != types.end() && (array->second[0] & 0xFFFF) == OpTypeArray)
+		{
+			type = array->second[2];
+			size = (int)constants[array->second[3]];
+		}
+
+		unsigned int glType = GetGLType(type, types);
+		if (glType == 0)
+		{
+			std::cout << "[ShaderCooker] uniform " << name->second << " has a type we cannot reflect" << std::endl;
+			continue;
+		}
+
+		//a uniform used by several stages is one uniform of the linked program
+		bool known = false;
+		for (const UniformInfo& uniform : uniforms)
+			known = known || uniform.Name == name->second;
+		if (known)
+			continue;
+
+		uniforms.push_back({ name->second, HashBytes(name->second.data(), name->second.size()), glType, size,
+			location->second, -1, -1, -1, -1, 0, 0, 0, -1 });
+	}
+
+	//a block is named after its struct type, as GLSL names it; the variable is the instance
+	for (const auto& variable : blockVariables)
+	{
+		auto pointer = types.find(variable.first);
+		auto binding = bindings.find(variable.second);
+		if (pointer == types.end() || binding == bindings.end())
+			continue;
+
+		//BufferBlock structs are storage buffers, UniformBuffer does not manage those
+		unsigned int type = pointer->second[3];
+		if (!blockTypes.count(type))
+			continue;
+		auto name = names.find(type);
+		if (name == names.end() || name->second.empty())
+		{
+			std::cout << "[ShaderCooker] cannot name the uniform block at binding " << binding->second
+				<< ", it keeps that binding" << std::endl;
+			continue;
+		}
+
+		bool known = false;
+		for (const SpirvBlock& block : blocks)
+			known = known || block.Name == name->second;
+		if (!known)
+			blocks.push_back({ name->second, binding->second });
+	}
+}
+
+bool ShaderCooker::Load(const std::string& filePath, unsigned long long sourceKey, SpirvPack& pack)
+{
+	std::string packPath = GetPackPath(filePath);
+	std::ifstream stream(packPath, std::ios::binary);
+	PackHeader header;
+	if (!stream || !stream.read((char*)&header, sizeof(header))
+		|| header.Magic != PackMagic || header.Version != PackVersion)
+		return false;
+	if (header.SourceKey != sourceKey)
+	{
+		std::cout << "[ShaderCooker] " << packPath << " is older than " << filePath << ", cook it again" << std::endl;
+		return false;
+	}
+
+	//every count comes from disk, a stale or corrupt pack must fail here instead of in a huge resize
+	std::streamoff dataStart = stream.tellg();
+	stream.seekg(0, std::ios::end);
+	std::streamoff fileEnd = stream.tellg();
+	stream.seekg(dataStart);
+	auto fits = [&](unsigned long long count, unsigned long long elementSize)
+	{
+		if (!stream)
+			return false;
+		std::streamoff remaining = fileEnd - stream.tellg();
+		if (remaining >= 0 && count <= (unsigned long long)remaining / elementSize)
+			return true;
+		std::cout << "[ShaderCooker] " << packPath << " is truncated" << std::endl;
+		return false;
+	};
+
+	pack.SourceKey = header.SourceKey;
+	unsigned int stageHeaderSize = sizeof(unsigned int) * 2;
+	if (!fits(header.StageCount, stageHeaderSize))
+		return false;
+	pack.Stages.resize(header.StageCount);
+	for (SpirvStage& stage : pack.Stages)
+	{
+		unsigned int words = 0;
+		stream.read((char*)&stage.Type, sizeof(stage.Type));
+		stream.read((char*)&words, sizeof(words));
+		if (!fits(words, sizeof(unsigned int)))
+			return false;
+		stage.Code.resize(words);
+		stream.read((char*)stage.Code.data(), words * sizeof(unsigned int));
+	}
+
+	unsigned int uniformHeaderSize = sizeof(int) + sizeof(unsigned int) + sizeof(int) + sizeof(unsigned int);
+	if (!fits(header.UniformCount, uniformHeaderSize))
+		return false;
+	pack.Uniforms.resize(header.UniformCount);
+	for (UniformInfo& uniform : pack.Uniforms)
+	{
+		unsigned int nameLength = 0;
+		stream.read((char*)&uniform.Location, sizeof(uniform.Location));
+		stream.read((char*)&uniform.Type, sizeof(uniform.Type));
+		stream.read((char*)&uniform.Size, sizeof(uniform.Size));
+		stream.read((char*)&nameLength, sizeof(nameLength));
+		if (!fits(nameLength, 1))
+			return false;
+		uniform.Name.resize(nameLength);
+		stream.read(&uniform.Name[0], nameLength);
+		uniform.Hash = HashBytes(uniform.Name.data(), uniform.Name.size());
+		uniform.Block = uniform.Offset = uniform.ArrayStride = uniform.MatrixStride = -1;
+		uniform.ShadowOffset = uniform.ShadowSize = uniform.Program = 0;
+		uniform.Next = -1;
+	}
+
+	unsigned int blockHeaderSize = sizeof(unsigned int) * 2;
+	if (!fits(header.BlockCount, blockHeaderSize))
+		return false;
+	pack.Blocks.resize(header.BlockCount);
+	for (SpirvBlock& block : pack.Blocks)
+	{
+		unsigned int nameLength = 0;
+		stream.read((char*)&block.Binding, sizeof(block.Binding));
+		stream.read((char*)&nameLength, sizeof(nameLength));
+		if (!fits(nameLength, 1))
+			return false;
+		block.Name.resize(nameLength);
+		stream.read(&block.Name[0], nameLength);
+	}
+
+	if (!stream)
+	{
+		std::cout << "[ShaderCooker] " << packPath << " is truncated" << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ShaderParser.h"
+#include "UniformTable.h"
+
+struct SpirvStage
+{
+	//GL shader type, e.g. GL_VERTEX_SHADER
+	unsigned int Type;
+	std::vector<unsigned int> Code;
+};
+
+// Everything a cooked shader needs at runtime. SPIR-V programs have no uniform
+// or block names for GL to report, so the cook step records them next to the code.
+// Blocks are recorded with the binding the compiler gave them; at load time they
+// are found by that binding and moved to the one their UniformBuffer registered.
+struct SpirvPack
+{
+	//MakeSourceKey of the .shader the pack was cooked from
+	unsigned long long SourceKey;
+	std::vector<SpirvStage> Stages;
+	//default-block uniforms only: Name, Hash, Type, Size and Location are filled in
+	std::vector<UniformInfo> Uniforms;
+	std::vector<SpirvBlock> Blocks;
+};
+
+// Offline cook step for GL_ARB_gl_spirv. Cook() parses a .shader file the same
+// way Shader does, compiles every stage to SPIR-V with glslangValidator (which
+// must be on the PATH), reflects the loose uniforms out of the SPIR-V and writes
+// it all to "<file>.spv". GLSL errors show up here instead of at startup.
+// Needs no GL context; run it as "ShaderApplication --cook <file.shader>...".
+class ShaderCooker
+{
+public:
+	static bool Cook(const std::string& filePath, const std::string& compiler = "glslangValidator");
+	static std::string GetPackPath(const std::string& filePath) { return filePath + ".spv"; }
+
+	//false when the pack is missing, broken or cooked from a different source
+	static bool Load(const std::string& filePath, unsigned long long sourceKey, SpirvPack& pack);
+
+	//hash of the parsed stages, independent of the GL driver unlike ShaderCache::MakeKey
+	static unsigned long long MakeSourceKey(const ShaderProgramSource& source);
+
+private:
+	static bool CompileStage(ShaderStage stage, const std::vector<ShaderSourceSpan>& source,
+		const std::string& compiler, const std::string& tempPath, std::vector<unsigned int>& code);
+	static void ReflectUniforms(const std::vector<unsigned int>& code, std::vector<UniformInfo>& uniforms,
+		std::vector<SpirvBlock>& blocks);
+};
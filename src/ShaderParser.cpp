@@ -0,0 +1,217 @@
+#include "ShaderParser.h"
+#include "Render.h"
+#include "GLExtensions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+std::unordered_map<std::string, std::shared_ptr<ShaderParser::Chunk>> ShaderParser::s_Chunks;
+
+static const char* s_StageNames[ShaderStageCount] = {
+	"vertex", "fragment", "geometry", "tess_control", "tess_evaluation", "compute"
+};
+
+unsigned int GetShaderStageType(ShaderStage stage)
+{
+	switch (stage)
+	{
+	case ShaderStage::Vertex:         return GL_VERTEX_SHADER;
+	case ShaderStage::Fragment:       return GL_FRAGMENT_SHADER;
+	case ShaderStage::Geometry:       return GL_GEOMETRY_SHADER;
+	case ShaderStage::TessControl:    return GL_TESS_CONTROL_SHADER;
+	case ShaderStage::TessEvaluation: return GL_TESS_EVALUATION_SHADER;
+	case ShaderStage::Compute:        return GL_COMPUTE_SHADER;
+	}
+	return 0;
+}
+
+const char* GetShaderStageName(ShaderStage stage)
+{
+	return s_StageNames[(int)stage];
+}
+
+static bool StartsWith(const char* p, const char* end, const char* word)
+{
+	size_t length = strlen(word);
+	return (size_t)(end - p) >= length && memcmp(p, word, length) == 0;
+}
+
+static const char* SkipSpaces(const char* p, const char* end)
+{
+	while (p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	return p;
+}
+
+static std::string GetDirectory(const std::string& filePath)
+{
+	size_t slash = filePath.find_last_of("/\\");
+	return slash == std::string::npos ? std::string() : filePath.substr(0, slash + 1);
+}
+
+std::shared_ptr<ShaderParser::Chunk> ShaderParser::Load(const std::string& filePath)
+{
+	auto cached = s_Chunks.find(filePath);
+	if (cached != s_Chunks.end())
+		return cached->second;
+
+	std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+	{
+		//read whole and closed right away, an open handle blocks editors from saving the file on Windows
+		std::ifstream stream(filePath, std::ios::binary);
+		if (!stream)
+		{
+			std::cout << "Failed to open shader file " << filePath << std::endl;
+			return nullptr;
+		}
+		stream.seekg(0, std::ios::end);
+		chunk->Text.resize((size_t)stream.tellg());
+		stream.seekg(0);
+		if (!chunk->Text.empty())
+			stream.read(&chunk->Text[0], chunk->Text.size());
+	}
+
+	const char* p = chunk->Text.data();
+	const char* end = p + chunk->Text.size();
+	const char* textStart = p;
+	int stage = -1;
+	std::string directory = GetDirectory(filePath);
+
+	//text between directives stays one span, directives themselves are dropped
+	auto flushText = [&](const char* textEnd)
+	{
+		if (textEnd > textStart)
+			chunk->Pieces.push_back({ { textStart, (int)(textEnd - textStart) }, std::string(), stage });
+	};
+
+	while (p < end)
+	{
+		const char* newline = (const char*)memchr(p, '\n', end - p);
+		const char* next = newline ? newline + 1 : end;
+		const char* s = SkipSpaces(p, next);
+
+		if (s < next && *s == '#')
+		{
+			const char* directive = SkipSpaces(s + 1, next);
+			if (StartsWith(directive, next, "shader"))
+			{
+				flushText(p);
+				const char* name = SkipSpaces(directive + 6, next);
+				const char* nameEnd = name;
+				while (nameEnd < next && (isalnum((unsigned char)*nameEnd) || *nameEnd == '_'))
+					nameEnd++;
+
+				stage = -1;
+				for (unsigned int i = 0; i < ShaderStageCount; i++)
+				{
+					if ((size_t)(nameEnd - name) == strlen(s_StageNames[i]) && StartsWith(name, nameEnd, s_StageNames[i]))
+						stage = i;
+				}
+				if (stage == -1)
+					std::cout << filePath << ": unknown shader stage '" << std::string(name, nameEnd) << "'" << std::endl;
+				textStart = next;
+			}
+			else if (StartsWith(directive, next, "include"))
+			{
+				flushText(p);
+				const char* open = (const char*)memchr(directive, '"', next - directive);
+				const char* close = open ? (const char*)memchr(open + 1, '"', next - open - 1) : nullptr;
+				if (close)
+					chunk->Pieces.push_back({ { nullptr, 0 }, directory + std::string(open + 1, close), stage });
+				else
+					std::cout << filePath << ": malformed #include" << std::endl;
+				textStart = next;
+			}
+		}
+		p = next;
+	}
+	flushText(end);
+
+	s_Chunks[filePath] = chunk;
+	return chunk;
+}
+
+bool ShaderParser::Flatten(const std::string& filePath, std::vector<ShaderSourceSpan>& out,
+	std::vector<std::string>& includeStack)
+{
+	if (std::find(includeStack.begin(), includeStack.end(), filePath) != includeStack.end())
+	{
+		std::cout << "Recursive #include of " << filePath << std::endl;
+		return false;
+	}
+
+	std::shared_ptr<Chunk> chunk = Load(filePath);
+	if (!chunk)
+		return false;
+
+	//an included file has no stages of its own, all of it goes where it was included
+	includeStack.push_back(filePath);
+	bool ok = true;
+	for (const Piece& piece : chunk->Pieces)
+	{
+		if (piece.Include.empty())
+			out.push_back(piece.Text);
+		else
+			ok = Flatten(piece.Include, out, includeStack) && ok;
+	}
+	includeStack.pop_back();
+	return ok;
+}
+
+bool ShaderParser::Parse(const std::string& filePath, ShaderProgramSource& source)
+{
+	std::shared_ptr<Chunk> chunk = Load(filePath);
+	if (!chunk)
+		return false;
+
+	bool ok = true;
+	std::vector<std::string> includeStack(1, filePath);
+	for (const Piece& piece : chunk->Pieces)
+	{
+		//text before the first #shader line belongs to no stage
+		if (piece.Stage < 0)
+			continue;
+
+		std::vector<ShaderSourceSpan>& stage = source.Stages[piece.Stage];
+		if (piece.Include.empty())
+			stage.push_back(piece.Text);
+		else
+			ok = Flatten(piece.Include, stage, includeStack) && ok;
+	}
+	return ok;
+}
+
+void ShaderParser::CollectDependencies(const std::string& filePath, std::vector<std::string>& out)
+{
+	if (std::find(out.begin(), out.end(), filePath) != out.end())
+		return;
+	out.push_back(filePath);
+
+	std::shared_ptr<Chunk> chunk = Load(filePath);
+	if (!chunk)
+		return;
+	for (const Piece& piece : chunk->Pieces)
+	{
+		if (!piece.Include.empty())
+			CollectDependencies(piece.Include, out);
+	}
+}
+
+std::vector<std::string> ShaderParser::GetDependencies(const std::string& filePath)
+{
+	std::vector<std::string> files;
+	CollectDependencies(filePath, files);
+	return files;
+}
+
+void ShaderParser::Invalidate(const std::string& filePath)
+{
+	s_Chunks.erase(filePath);
+}
+
+void ShaderParser::ClearCache()
+{
+	s_Chunks.clear();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+
+enum class ShaderStage
+{
+	Vertex = 0, Fragment, Geometry, TessControl, TessEvaluation, Compute
+};
+const unsigned int ShaderStageCount = 6;
+
+unsigned int GetShaderStageType(ShaderStage stage);
+const char* GetShaderStageName(ShaderStage stage);
+
+//piece of shader text that lives somewhere else, not NUL terminated
+struct ShaderSourceSpan
+{
+	const char* Data;
+	int Length;
+};
+
+// Source of every stage of a program as a list of spans, handed to
+// glShaderSource as is. Spans point into file text owned by ShaderParser's
+// chunk cache or into Storage, so a source is only good until the cache entry
+// is invalidated and must not be copied.
+struct ShaderProgramSource
+{
+	std::vector<ShaderSourceSpan> Stages[ShaderStageCount];
+	//text made up while preparing the source, e.g. injected #defines
+	std::deque<std::string> Storage;
+
+	ShaderProgramSource() {}
+	ShaderProgramSource(const ShaderProgramSource&) = delete;
+	ShaderProgramSource& operator=(const ShaderProgramSource&) = delete;
+
+	inline bool HasStage(ShaderStage stage) const { return !Stages[(int)stage].empty(); }
+};
+
+// Parses .shader files. "#shader <stage>" lines split the file into stages
+// (vertex, fragment, geometry, tess_control, tess_evaluation, compute) and
+// "#include "file"" pulls in another file, relative to the including one.
+// Every file is read whole into its chunk and closed again, so no file stays
+// locked or can change under the parser, then scanned once into text spans
+// and include references that all shaders share.
+class ShaderParser
+{
+private:
+	struct Piece
+	{
+		ShaderSourceSpan Text;
+		//non-empty for an #include, already resolved to a path
+		std::string Include;
+		//-1 before the first #shader line
+		int Stage;
+	};
+
+	struct Chunk
+	{
+		//the whole file, the pieces' spans point into it
+		std::string Text;
+		std::vector<Piece> Pieces;
+	};
+
+	static std::unordered_map<std::string, std::shared_ptr<Chunk>> s_Chunks;
+
+public:
+	static bool Parse(const std::string& filePath, ShaderProgramSource& source);
+
+	//the file itself and everything it includes, directly or not
+	static std::vector<std::string> GetDependencies(const std::string& filePath);
+
+	//drops the cached chunk so the next Parse maps the file again
+	static void Invalidate(const std::string& filePath);
+	static void ClearCache();
+
+private:
+	static std::shared_ptr<Chunk> Load(const std::string& filePath);
+	static bool Flatten(const std::string& filePath, std::vector<ShaderSourceSpan>& out,
+		std::vector<std::string>& includeStack);
+	static void CollectDependencies(const std::string& filePath, std::vector<std::string>& out);
+};
@@ -0,0 +1,130 @@
+#include "ShaderPipeline.h"
+#include "Render.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+#include "Hash.h"
+#include "UniformTable.h"
+
+#include <algorithm>
+#include <iostream>
+
+std::unordered_map<unsigned long long, ShaderPipeline::StageProgram> ShaderPipeline::s_Programs;
+std::unordered_map<unsigned long long, ShaderPipeline::Pipeline> ShaderPipeline::s_Pipelines;
+
+static const unsigned int s_StageBits[ShaderStageCount] = {
+	GL_VERTEX_SHADER_BIT, GL_FRAGMENT_SHADER_BIT, GL_GEOMETRY_SHADER_BIT,
+	GL_TESS_CONTROL_SHADER_BIT, GL_TESS_EVALUATION_SHADER_BIT, GL_COMPUTE_SHADER_BIT
+};
+
+bool ShaderPipeline::IsSupported()
+{
+	return GLExtensions::HasSeparateShaderObjects();
+}
+
+unsigned long long ShaderPipeline::MakeStageKey(ShaderStage stage, const std::vector<ShaderSourceSpan>& source)
+{
+	unsigned int type = GetShaderStageType(stage);
+	unsigned long long hash = HashBytes(&type, sizeof(type));
+	for (const ShaderSourceSpan& span : source)
+		hash = HashBytes(span.Data, span.Length, hash);
+	return hash;
+}
+
+unsigned int ShaderPipeline::AcquireStageProgram(unsigned long long key)
+{
+	auto found = s_Programs.find(key);
+	if (found == s_Programs.end())
+		return 0;
+	found->second.References++;
+	return found->second.Program;
+}
+
+void ShaderPipeline::AddStageProgram(unsigned long long key, unsigned int program)
+{
+	s_Programs[key] = { program, 1 };
+}
+
+void ShaderPipeline::ReleaseStageProgram(unsigned int program)
+{
+	auto found = s_Programs.begin();
+	while (found != s_Programs.end() && found->second.Program != program)
+		++found;
+	if (found == s_Programs.end() || --found->second.References > 0)
+		return;
+
+	for (auto it = s_Pipelines.begin(); it != s_Pipelines.end(); )
+	{
+		const unsigned int* programs = it->second.Programs;
+		if (std::find(programs, programs + ShaderStageCount, program) != programs + ShaderStageCount)
+		{
+			DeletePipeline(it->second.RendererID);
+			it = s_Pipelines.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	GLState::OnDeleteProgram(program);
+	GLCall(glDeleteProgram(program));
+	UniformTable::ForgetProgram(program);
+	s_Programs.erase(found);
+}
+
+void ShaderPipeline::DeletePipeline(unsigned int pipeline)
+{
+	GLState::OnDeleteProgramPipeline(pipeline);
+	GLCall(GLExtensions::DeleteProgramPipelines(1, &pipeline));
+}
+
+unsigned int ShaderPipeline::GetPipeline(const unsigned int* programs)
+{
+	unsigned long long key = HashBytes(programs, sizeof(unsigned int) * ShaderStageCount);
+	auto found = s_Pipelines.find(key);
+	if (found != s_Pipelines.end())
+		return found->second.RendererID;
+
+	unsigned int pipeline = 0;
+	GLCall(GLExtensions::GenProgramPipelines(1, &pipeline));
+	for (unsigned int i = 0; i < ShaderStageCount; i++)
+	{
+		if (programs[i])
+		{
+			GLCall(GLExtensions::UseProgramStages(pipeline, s_StageBits[i], programs[i]));
+		}
+	}
+
+	//the interface between stages is only checked here, a mismatch draws nothing later
+	GLCall(GLExtensions::ValidateProgramPipeline(pipeline));
+	int valid = GL_FALSE;
+	GLCall(GLExtensions::GetProgramPipelineiv(pipeline, GL_VALIDATE_STATUS, &valid));
+	if (valid == GL_FALSE)
+	{
+		int length = 0;
+		GLCall(GLExtensions::GetProgramPipelineiv(pipeline, GL_INFO_LOG_LENGTH, &length));
+		std::vector<char> message(length + 1);
+		GLCall(GLExtensions::GetProgramPipelineInfoLog(pipeline, length, &length, message.data()));
+		std::cout << "Program pipeline " << pipeline << " failed to validate" << std::endl;
+		std::cout << message.data() << std::endl;
+	}
+
+	Pipeline& entry = s_Pipelines[key];
+	entry.RendererID = pipeline;
+	std::copy(programs, programs + ShaderStageCount, entry.Programs);
+	return pipeline;
+}
+
+void ShaderPipeline::Clear()
+{
+	for (auto& entry : s_Pipelines)
+		DeletePipeline(entry.second.RendererID);
+	for (auto& entry : s_Programs)
+	{
+		GLState::OnDeleteProgram(entry.second.Program);
+		GLCall(glDeleteProgram(entry.second.Program));
+		UniformTable::ForgetProgram(entry.second.Program);
+	}
+	s_Pipelines.clear();
+	s_Programs.clear();
+}
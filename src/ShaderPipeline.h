@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "ShaderParser.h"
+
+// Process-wide caches for ShaderLoadMode::Separable (ARB_separate_shader_objects).
+// Each stage is linked into its own separable program, keyed by its final
+// source, and programs are combined at bind time through pipeline objects
+// keyed by the programs they use. N vertex and M fragment variants cost N+M
+// links instead of N*M; every Shader sharing a stage shares its program.
+// Stage programs are reference counted: the last release deletes the program
+// and every pipeline using it, so stages left behind by reloads (or by a
+// shader whose other stages failed) do not pile up.
+class ShaderPipeline
+{
+private:
+	struct StageProgram
+	{
+		unsigned int Program;
+		unsigned int References;
+	};
+
+	struct Pipeline
+	{
+		unsigned int RendererID;
+		unsigned int Programs[ShaderStageCount];
+	};
+
+public:
+	static bool IsSupported();
+
+	static unsigned long long MakeStageKey(ShaderStage stage, const std::vector<ShaderSourceSpan>& source);
+	//separable program compiled from the same source before with a new reference to it, 0 on a miss
+	static unsigned int AcquireStageProgram(unsigned long long key);
+	//adds the program with one reference
+	static void AddStageProgram(unsigned long long key, unsigned int program);
+	//drops a reference from Acquire or Add, programs Clear() already deleted are ignored
+	static void ReleaseStageProgram(unsigned int program);
+
+	//pipeline using programs[stage] for every stage, 0 entries leave the stage empty
+	static unsigned int GetPipeline(const unsigned int* programs);
+
+	//deletes every program and pipeline, no Separable shader may be used afterwards
+	static void Clear();
+
+	static inline unsigned int GetProgramCount() { return (unsigned int)s_Programs.size(); }
+	static inline unsigned int GetPipelineCount() { return (unsigned int)s_Pipelines.size(); }
+
+private:
+	static void DeletePipeline(unsigned int pipeline);
+
+	static std::unordered_map<unsigned long long, StageProgram> s_Programs;
+	static std::unordered_map<unsigned long long, Pipeline> s_Pipelines;
+};
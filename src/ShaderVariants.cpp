@@ -0,0 +1,83 @@
+#include "ShaderVariants.h"
+#include "Render.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+ShaderVariants::ShaderVariants(const std::string& filepath, const std::vector<std::string>& keywords, ShaderLoadMode mode)
+	:m_FilePath(filepath), m_Keywords(keywords), m_Mode(mode)
+{
+	ASSERT(keywords.size() <= MaxKeywords);
+	m_Variants.resize(1u << keywords.size());
+}
+
+unsigned int ShaderVariants::GetKeywordBit(const std::string& keyword) const
+{
+	for (unsigned int i = 0; i < m_Keywords.size(); i++)
+	{
+		if (m_Keywords[i] == keyword)
+			return 1u << i;
+	}
+	std::cout << "Warning keyword '" << keyword << "' is not declared for " << m_FilePath << std::endl;
+	return 0;
+}
+
+unsigned int ShaderVariants::GetMask(const std::vector<std::string>& keywords) const
+{
+	unsigned int mask = 0;
+	for (const std::string& keyword : keywords)
+		mask |= GetKeywordBit(keyword);
+	return mask;
+}
+
+void ShaderVariants::Prewarm(unsigned int mask)
+{
+	if (!IsCompiled(mask))
+		Compile(mask);
+}
+
+unsigned int ShaderVariants::PrewarmFromManifest(const std::string& manifestPath)
+{
+	std::ifstream stream(manifestPath);
+	if (!stream)
+	{
+		std::cout << "Failed to open variant manifest " << manifestPath << std::endl;
+		return 0;
+	}
+
+	unsigned int compiled = 0;
+	std::string line;
+	while (getline(stream, line))
+	{
+		line = line.substr(0, line.find('#'));
+		std::stringstream ss(line);
+		std::vector<std::string> keywords;
+		std::string keyword;
+		while (ss >> keyword)
+			keywords.push_back(keyword);
+		if (keywords.empty())
+			continue;
+
+		unsigned int mask = GetMask(keywords);
+		if (!IsCompiled(mask))
+		{
+			Compile(mask);
+			compiled++;
+		}
+	}
+	return compiled;
+}
+
+void ShaderVariants::Compile(unsigned int mask)
+{
+	mask &= (unsigned int)m_Variants.size() - 1;
+
+	std::vector<std::string> defines;
+	for (unsigned int i = 0; i < m_Keywords.size(); i++)
+	{
+		if (mask & (1u << i))
+			defines.push_back(m_Keywords[i]);
+	}
+	m_Variants[mask].reset(new Shader(m_FilePath, defines, m_Mode));
+}
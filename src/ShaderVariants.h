@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Shader.h"
+
+// Feature permutations of one .shader file. Every keyword is a bit in a variant
+// mask and each variant is the file compiled with its keywords #define'd. The
+// variants sit in a table indexed by mask and are compiled the first time they
+// are asked for, or ahead of time with Prewarm()/PrewarmFromManifest().
+class ShaderVariants
+{
+private:
+	std::string m_FilePath;
+	std::vector<std::string> m_Keywords;
+	ShaderLoadMode m_Mode;
+	std::vector<std::unique_ptr<Shader>> m_Variants;
+
+public:
+	//keeps the table at 256 entries at most
+	static const unsigned int MaxKeywords = 8;
+
+	ShaderVariants(const std::string& filepath, const std::vector<std::string>& keywords,
+		ShaderLoadMode mode = ShaderLoadMode::Blocking);
+
+	//bit of the keyword in a variant mask, 0 when the keyword is unknown; resolve once
+	unsigned int GetKeywordBit(const std::string& keyword) const;
+	unsigned int GetMask(const std::vector<std::string>& keywords) const;
+
+	//one table access once the variant exists
+	inline Shader& Get(unsigned int mask)
+	{
+		std::unique_ptr<Shader>& variant = m_Variants[mask & (m_Variants.size() - 1)];
+		if (!variant)
+			Compile(mask);
+		return *variant;
+	}
+	inline bool IsCompiled(unsigned int mask) const { return m_Variants[mask & (m_Variants.size() - 1)] != nullptr; }
+
+	void Prewarm(unsigned int mask);
+	//one variant per line as space separated keywords, '#' starts a comment;
+	//returns how many variants were compiled
+	unsigned int PrewarmFromManifest(const std::string& manifestPath);
+
+private:
+	void Compile(unsigned int mask);
+};
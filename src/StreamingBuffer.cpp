@@ -0,0 +1,125 @@
+#include "StreamingBuffer.h"
+#include "Render.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+
+StreamingBuffer::StreamingBuffer(unsigned int regionSize)
+	:m_RenderID(0), m_RegionSize(regionSize), m_Region(0), m_Offset(0), m_MappedOffset(0),
+	m_Persistent(false), m_Waited(false), m_Mapped(nullptr), m_Stalls(0)
+{
+	for (unsigned int i = 0; i < RegionCount; i++)
+		m_Fences[i] = nullptr;
+
+	GLCall(glGenBuffers(1, &m_RenderID));
+	GLState::BindArrayBuffer(m_RenderID);
+
+	unsigned int size = m_RegionSize * RegionCount;
+	if (GLExtensions::HasBufferStorage())
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLCall(GLExtensions::BufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags));
+		GLCall(m_Mapped = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+		m_Persistent = m_Mapped != nullptr;
+	}
+	else
+	{
+		GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW));
+	}
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+	for (unsigned int i = 0; i < RegionCount; i++)
+	{
+		if (m_Fences[i])
+		{
+			GLCall(glDeleteSync(m_Fences[i]));
+		}
+	}
+
+	//deleting a buffer unmaps it, persistent or not
+	GLState::OnDeleteBuffer(m_RenderID);
+	GLCall(glDeleteBuffers(1, &m_RenderID));
+}
+
+void* StreamingBuffer::Map(unsigned int size, unsigned int alignment)
+{
+	//the first write of a frame waits until the GPU is done with the region's last use
+	if (!m_Waited)
+		WaitRegion();
+
+	unsigned int regionEnd = (m_Region + 1) * m_RegionSize;
+	unsigned int offset = (m_Offset + alignment - 1) / alignment * alignment;
+	if (offset + size > regionEnd)
+		return nullptr;
+
+	m_MappedOffset = offset;
+	m_Offset = offset + size;
+	if (m_Persistent)
+		return m_Mapped + offset;
+
+	//the fence already covers the range, the driver does not need to synchronize
+	GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+	Bind();
+	void* data;
+	GLCall(data = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, access));
+	return data;
+}
+
+unsigned int StreamingBuffer::Unmap()
+{
+	if (!m_Persistent)
+	{
+		Bind();
+		GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+	}
+	return m_MappedOffset;
+}
+
+void StreamingBuffer::NextFrame()
+{
+	//nothing was written this frame, the region's old fence still applies
+	if (!m_Waited)
+		return;
+
+	GLCall(m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	m_Region = (m_Region + 1) % RegionCount;
+	m_Offset = m_Region * m_RegionSize;
+	m_Waited = false;
+}
+
+void StreamingBuffer::Bind() const
+{
+	GLState::BindArrayBuffer(m_RenderID);
+}
+
+void StreamingBuffer::UnBind() const
+{
+	GLState::BindArrayBuffer(0);
+}
+
+void StreamingBuffer::WaitRegion()
+{
+	m_Waited = true;
+	GLsync fence = m_Fences[m_Region];
+	if (!fence)
+		return;
+
+	//poll first, only count a stall when the GPU really is behind
+	GLenum result;
+	GLCall(result = glClientWaitSync(fence, 0, 0));
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		m_Stalls++;
+		//flush once so the fence is guaranteed to signal, then wait in 1ms steps
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		do
+		{
+			GLCall(result = glClientWaitSync(fence, flags, 1000000));
+			flags = 0;
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+
+	GLCall(glDeleteSync(fence));
+	m_Fences[m_Region] = nullptr;
+}
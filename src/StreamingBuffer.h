@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Vertex buffer for geometry that is rewritten every frame (particles, UI).
+// The buffer is split into RegionCount regions, one per frame in flight: the
+// CPU writes into the current region while the GPU may still read the older
+// ones, and a fence per region tells when it is safe to write it again.
+// With GL 4.4 / ARB_buffer_storage the whole buffer stays persistently and
+// coherently mapped, so Map() is only pointer arithmetic. Without it each
+// Map() falls back to an unsynchronized glMapBufferRange of the range.
+class StreamingBuffer
+{
+public:
+	static const unsigned int RegionCount = 3;
+
+private:
+	unsigned int m_RenderID;
+	unsigned int m_RegionSize;
+	unsigned int m_Region;
+	//next free byte, relative to the start of the buffer
+	unsigned int m_Offset;
+	//offset of the range handed out by the last Map()
+	unsigned int m_MappedOffset;
+	bool m_Persistent;
+	bool m_Waited;
+	char* m_Mapped;
+	GLsync m_Fences[RegionCount];
+	unsigned int m_Stalls;
+
+public:
+	//regionSize is the most that can be written in one frame
+	StreamingBuffer(unsigned int regionSize);
+	~StreamingBuffer();
+
+	StreamingBuffer(const StreamingBuffer&) = delete;
+	StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+	//returns memory for size bytes in the current region, starting at a multiple of alignment
+	//(pass the vertex stride so the offset converts to a first vertex), nullptr when the region is full
+	void* Map(unsigned int size, unsigned int alignment = 4);
+	//ends the write started by Map(), returns its byte offset in the buffer
+	unsigned int Unmap();
+	//fences the commands that read the current region and moves on to the next one
+	void NextFrame();
+
+	void Bind() const;
+	void UnBind() const;
+
+	inline unsigned int GetRendererID() const { return m_RenderID; }
+	inline unsigned int GetRegionSize() const { return m_RegionSize; }
+	inline bool IsPersistent() const { return m_Persistent; }
+	//how often Map() had to wait for the GPU, the ring is too short when this grows
+	inline unsigned int GetStallCount() const { return m_Stalls; }
+
+private:
+	void WaitRegion();
+};
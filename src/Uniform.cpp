@@ -0,0 +1,55 @@
+#include "Uniform.h"
+#include "Render.h"
+#include "GLExtensions.h"
+
+void UploadUniform(int location, unsigned int type, int count, const void* data)
+{
+	const float* f = (const float*)data;
+	const int* i = (const int*)data;
+	const unsigned int* u = (const unsigned int*)data;
+	switch (type)
+	{
+	case GL_FLOAT:             GLCall(glUniform1fv(location, count, f)); break;
+	case GL_FLOAT_VEC2:        GLCall(glUniform2fv(location, count, f)); break;
+	case GL_FLOAT_VEC3:        GLCall(glUniform3fv(location, count, f)); break;
+	case GL_FLOAT_VEC4:        GLCall(glUniform4fv(location, count, f)); break;
+	case GL_FLOAT_MAT2:        GLCall(glUniformMatrix2fv(location, count, GL_FALSE, f)); break;
+	case GL_FLOAT_MAT3:        GLCall(glUniformMatrix3fv(location, count, GL_FALSE, f)); break;
+	case GL_FLOAT_MAT4:        GLCall(glUniformMatrix4fv(location, count, GL_FALSE, f)); break;
+	case GL_INT_VEC2:  case GL_BOOL_VEC2: GLCall(glUniform2iv(location, count, i)); break;
+	case GL_INT_VEC3:  case GL_BOOL_VEC3: GLCall(glUniform3iv(location, count, i)); break;
+	case GL_INT_VEC4:  case GL_BOOL_VEC4: GLCall(glUniform4iv(location, count, i)); break;
+	case GL_UNSIGNED_INT:      GLCall(glUniform1uiv(location, count, u)); break;
+	case GL_UNSIGNED_INT_VEC2: GLCall(glUniform2uiv(location, count, u)); break;
+	case GL_UNSIGNED_INT_VEC3: GLCall(glUniform3uiv(location, count, u)); break;
+	case GL_UNSIGNED_INT_VEC4: GLCall(glUniform4uiv(location, count, u)); break;
+	//int, bool and the sampler types
+	default:                   GLCall(glUniform1iv(location, count, i)); break;
+	}
+}
+
+void UploadProgramUniform(unsigned int program, int location, unsigned int type, int count, const void* data)
+{
+	const float* f = (const float*)data;
+	const int* i = (const int*)data;
+	const unsigned int* u = (const unsigned int*)data;
+	switch (type)
+	{
+	case GL_FLOAT:             GLCall(GLExtensions::ProgramUniform1fv(program, location, count, f)); break;
+	case GL_FLOAT_VEC2:        GLCall(GLExtensions::ProgramUniform2fv(program, location, count, f)); break;
+	case GL_FLOAT_VEC3:        GLCall(GLExtensions::ProgramUniform3fv(program, location, count, f)); break;
+	case GL_FLOAT_VEC4:        GLCall(GLExtensions::ProgramUniform4fv(program, location, count, f)); break;
+	case GL_FLOAT_MAT2:        GLCall(GLExtensions::ProgramUniformMatrix2fv(program, location, count, GL_FALSE, f)); break;
+	case GL_FLOAT_MAT3:        GLCall(GLExtensions::ProgramUniformMatrix3fv(program, location, count, GL_FALSE, f)); break;
+	case GL_FLOAT_MAT4:        GLCall(GLExtensions::ProgramUniformMatrix4fv(program, location, count, GL_FALSE, f)); break;
+	case GL_INT_VEC2:  case GL_BOOL_VEC2: GLCall(GLExtensions::ProgramUniform2iv(program, location, count, i)); break;
+	case GL_INT_VEC3:  case GL_BOOL_VEC3: GLCall(GLExtensions::ProgramUniform3iv(program, location, count, i)); break;
+	case GL_INT_VEC4:  case GL_BOOL_VEC4: GLCall(GLExtensions::ProgramUniform4iv(program, location, count, i)); break;
+	case GL_UNSIGNED_INT:      GLCall(GLExtensions::ProgramUniform1uiv(program, location, count, u)); break;
+	case GL_UNSIGNED_INT_VEC2: GLCall(GLExtensions::ProgramUniform2uiv(program, location, count, u)); break;
+	case GL_UNSIGNED_INT_VEC3: GLCall(GLExtensions::ProgramUniform3uiv(program, location, count, u)); break;
+	case GL_UNSIGNED_INT_VEC4: GLCall(GLExtensions::ProgramUniform4uiv(program, location, count, u)); break;
+	//int, bool and the sampler types
+	default:                   GLCall(GLExtensions::ProgramUniform1iv(program, location, count, i)); break;
+	}
+}
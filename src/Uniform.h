@@ -0,0 +1,146 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+#include "Hash.h"
+
+// Typed uniform handles. Names are hashed with the _u literal; a literal passed
+// straight to a call may still be hashed at run time, so keep it in a constexpr
+// variable to be sure it is folded:
+//   static constexpr UniformName ColorName = "u_Color"_u;
+//   Uniform<Vec4> color = shader.GetUniform<Vec4>(ColorName);
+//   shader.SetUniform(color, Vec4{ r, 0.3f, 0.8f, 1.0f });
+// The C++ type picks the glUniform* call through UniformTraits, so passing the
+// wrong type does not compile, and resolving against a program whose GLSL type
+// differs gives an invalid handle instead of a GL error later on. Arrays are set
+// from a pointer to their first element and a count.
+
+struct UniformName
+{
+	unsigned long long Hash;
+};
+
+constexpr UniformName operator"" _u(const char* name, size_t length)
+{
+	return UniformName{ HashChars(name, length) };
+}
+
+struct Vec2 { float x, y; };
+struct Vec3 { float x, y, z; };
+struct Vec4 { float x, y, z, w; };
+struct IVec2 { int x, y; };
+struct IVec3 { int x, y, z; };
+struct IVec4 { int x, y, z, w; };
+struct UVec2 { unsigned int x, y; };
+struct UVec3 { unsigned int x, y, z; };
+struct UVec4 { unsigned int x, y, z, w; };
+//column-major, as glUniformMatrix*fv expects with transpose off
+struct Mat2 { float m[4]; };
+struct Mat3 { float m[9]; };
+struct Mat4 { float m[16]; };
+
+//GLSL type of each C++ type and the reflected types it may be bound to;
+//no specialization means no uniform of that type
+template<typename T> struct UniformTraits;
+
+template<> struct UniformTraits<float>
+{
+	static const unsigned int Type = GL_FLOAT;
+	static bool Matches(unsigned int type) { return type == GL_FLOAT; }
+};
+template<> struct UniformTraits<int>
+{
+	static const unsigned int Type = GL_INT;
+	//samplers are set through their texture unit index
+	static bool Matches(unsigned int type)
+	{
+		return type == GL_INT || type == GL_BOOL || type == GL_SAMPLER_2D || type == GL_SAMPLER_3D
+			|| type == GL_SAMPLER_CUBE || type == GL_SAMPLER_2D_ARRAY || type == GL_SAMPLER_2D_SHADOW;
+	}
+};
+template<> struct UniformTraits<unsigned int>
+{
+	static const unsigned int Type = GL_UNSIGNED_INT;
+	static bool Matches(unsigned int type) { return type == GL_UNSIGNED_INT; }
+};
+template<> struct UniformTraits<Vec2>
+{
+	static const unsigned int Type = GL_FLOAT_VEC2;
+	static bool Matches(unsigned int type) { return type == GL_FLOAT_VEC2; }
+};
+template<> struct UniformTraits<Vec3>
+{
+	static const unsigned int Type = GL_FLOAT_VEC3;
+	static bool Matches(unsigned int type) { return type == GL_FLOAT_VEC3; }
+};
+template<> struct UniformTraits<Vec4>
+{
+	static const unsigned int Type = GL_FLOAT_VEC4;
+	static bool Matches(unsigned int type) { return type == GL_FLOAT_VEC4; }
+};
+template<> struct UniformTraits<IVec2>
+{
+	static const unsigned int Type = GL_INT_VEC2;
+	static bool Matches(unsigned int type) { return type == GL_INT_VEC2 || type == GL_BOOL_VEC2; }
+};
+template<> struct UniformTraits<IVec3>
+{
+	static const unsigned int Type = GL_INT_VEC3;
+	static bool Matches(unsigned int type) { return type == GL_INT_VEC3 || type == GL_BOOL_VEC3; }
+};
+template<> struct UniformTraits<IVec4>
+{
+	static const unsigned int Type = GL_INT_VEC4;
+	static bool Matches(unsigned int type) { return type == GL_INT_VEC4 || type == GL_BOOL_VEC4; }
+};
+template<> struct UniformTraits<UVec2>
+{
+	static const unsigned int Type = GL_UNSIGNED_INT_VEC2;
+	static bool Matches(unsigned int type) { return type == GL_UNSIGNED_INT_VEC2; }
+};
+template<> struct UniformTraits<UVec3>
+{
+	static const unsigned int Type = GL_UNSIGNED_INT_VEC3;
+	static bool Matches(unsigned int type) { return type == GL_UNSIGNED_INT_VEC3; }
+};
+template<> struct UniformTraits<UVec4>
+{
+	static const unsigned int Type = GL_UNSIGNED_INT_VEC4;
+	static bool Matches(unsigned int type) { return type == GL_UNSIGNED_INT_VEC4; }
+};
+template<> struct UniformTraits<Mat2>
+{
+	static const unsigned int Type = GL_FLOAT_MAT2;
+	static bool Matches(unsigned int type) { return type == GL_FLOAT_MAT2; }
+};
+template<> struct UniformTraits<Mat3>
+{
+	static const unsigned int Type = GL_FLOAT_MAT3;
+	static bool Matches(unsigned int type) { return type == GL_FLOAT_MAT3; }
+};
+template<> struct UniformTraits<Mat4>
+{
+	static const unsigned int Type = GL_FLOAT_MAT4;
+	static bool Matches(unsigned int type) { return type == GL_FLOAT_MAT4; }
+};
+
+template<typename T>
+struct Uniform
+{
+	//index into the shader's UniformTable, -1 when unresolved
+	int Handle;
+
+	Uniform()
+		:Handle(-1) {}
+	explicit Uniform(int handle)
+		:Handle(handle) {}
+
+	inline bool IsValid() const { return Handle >= 0; }
+};
+
+//count elements of a GL uniform type (a UniformTraits Type or a reflected one) from
+//memory laid out like the C++ types above, into the currently bound program
+void UploadUniform(int location, unsigned int type, int count, const void* data);
+//same, straight into program whether it is bound or not (glProgramUniform*, GL 4.1)
+void UploadProgramUniform(unsigned int program, int location, unsigned int type, int count, const void* data);
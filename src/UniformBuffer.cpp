@@ -0,0 +1,198 @@
+#include "UniformBuffer.h"
+#include "UniformTable.h"
+#include "Shader.h"
+#include "Render.h"
+#include "GLState.h"
+
+#include <iostream>
+
+std::unordered_map<std::string, unsigned int> UniformBuffer::s_Bindings;
+
+static unsigned int RoundUp(unsigned int value, unsigned int alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+//columns and rows of the square float matrices, 0 for everything else
+static unsigned int GetMatrixColumns(unsigned int type)
+{
+	switch (type)
+	{
+	case GL_FLOAT_MAT2: return 2;
+	case GL_FLOAT_MAT3: return 3;
+	case GL_FLOAT_MAT4: return 4;
+	default: return 0;
+	}
+}
+
+void UniformBlockLayout::PushMember(const std::string& name, unsigned int type, unsigned int count)
+{
+	//base alignment and size of one element
+	unsigned int size = UniformTable::GetTypeSize(type);
+	unsigned int alignment;
+	switch (type)
+	{
+	case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2:
+		alignment = 8;
+		break;
+	case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3:
+	case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4:
+		alignment = 16;
+		break;
+	default:
+		alignment = 4;
+		break;
+	}
+	ASSERT(size != 0);
+
+	//a matrix is an array of column vectors: std140 pads every column to a vec4,
+	//std430 only to the column's own alignment (a mat2 column stays a packed vec2)
+	unsigned int columns = GetMatrixColumns(type);
+	unsigned int matrixStride = 0;
+	if (columns)
+	{
+		matrixStride = m_Rule == BlockLayoutRule::Std140 || columns > 2 ? 16 : 8;
+		alignment = matrixStride;
+		size = matrixStride * columns;
+	}
+
+	unsigned int stride = 0;
+	if (count > 1)
+	{
+		//std140 rounds array elements up to a vec4, std430 only to their own alignment
+		if (m_Rule == BlockLayoutRule::Std140)
+			alignment = RoundUp(alignment, 16);
+		stride = RoundUp(size, alignment);
+	}
+
+	unsigned int offset = RoundUp(m_Size, alignment);
+	m_Members.push_back({ name, HashBytes(name.data(), name.size()), type, count, offset, stride, matrixStride });
+	m_Size = offset + (count > 1 ? stride * count : size);
+}
+
+int UniformBlockLayout::Find(unsigned long long hash) const
+{
+	for (unsigned int i = 0; i < m_Members.size(); i++)
+	{
+		if (m_Members[i].Hash == hash)
+			return i;
+	}
+	return -1;
+}
+
+bool UniformBlockLayout::Validate(const UniformTable& uniforms, const std::string& blockName) const
+{
+	int block = uniforms.FindBlock(blockName.c_str());
+	if (block < 0)
+	{
+		std::cout << "[UniformBuffer] program does not declare block " << blockName << std::endl;
+		return false;
+	}
+
+	bool ok = true;
+	for (const UniformBlockMember& member : m_Members)
+	{
+		//members of a block with an instance name are reflected as "Block.member"
+		int handle = uniforms.Find(member.Name.c_str());
+		if (handle < 0)
+			handle = uniforms.Find((blockName + "." + member.Name).c_str());
+		if (handle < 0 || uniforms.Get(handle).Block != block)
+		{
+			std::cout << "[UniformBuffer] " << blockName << "." << member.Name << " is not in the program's block" << std::endl;
+			ok = false;
+			continue;
+		}
+
+		const UniformInfo& info = uniforms.Get(handle);
+		bool strideOk = (member.Count <= 1 || info.ArrayStride == (int)member.ArrayStride)
+			&& (member.MatrixStride == 0 || info.MatrixStride == (int)member.MatrixStride);
+		if (info.Type != member.Type || info.Offset != (int)member.Offset || !strideOk)
+		{
+			std::cout << "[UniformBuffer] " << blockName << "." << member.Name << " expected offset " << member.Offset
+				<< " stride " << member.ArrayStride << ", program has offset " << info.Offset
+				<< " stride " << info.ArrayStride << std::endl;
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+UniformBuffer::UniformBuffer(const std::string& blockName, const UniformBlockLayout& layout, unsigned int binding)
+	:m_Binding(binding), m_BlockName(blockName), m_Layout(layout), m_Data(layout.GetSize(), 0), m_Dirty(false)
+{
+	RegisterBinding(blockName, binding);
+
+	GLCall(glGenBuffers(1, &m_RenderID));
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RenderID));
+	GLCall(glBufferData(GL_UNIFORM_BUFFER, m_Data.size(), m_Data.data(), GL_DYNAMIC_DRAW));
+	Bind();
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	GLState::OnDeleteBuffer(m_RenderID);
+	GLCall(glDeleteBuffers(1, &m_RenderID));
+}
+
+void UniformBuffer::Upload()
+{
+	if (!m_Dirty)
+		return;
+
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RenderID));
+	GLCall(glBufferSubData(GL_UNIFORM_BUFFER, 0, m_Data.size(), m_Data.data()));
+	m_Dirty = false;
+}
+
+void UniformBuffer::Bind() const
+{
+	GLState::BindUniformBuffer(m_Binding, m_RenderID);
+}
+
+bool UniformBuffer::Validate(const Shader& shader) const
+{
+	return m_Layout.Validate(shader.GetUniforms(), m_BlockName);
+}
+
+void UniformBuffer::RegisterBinding(const std::string& blockName, unsigned int binding)
+{
+	s_Bindings[blockName] = binding;
+}
+
+int UniformBuffer::FindBinding(const std::string& blockName)
+{
+	auto it = s_Bindings.find(blockName);
+	return it == s_Bindings.end() ? -1 : (int)it->second;
+}
+
+void UniformBuffer::Write(const UniformBlockMember& member, unsigned int element, const void* value, unsigned int size)
+{
+	ASSERT(element < member.Count);
+	if (element >= member.Count)
+	{
+		std::cout << "[UniformBuffer] " << m_BlockName << "." << member.Name << " has " << member.Count
+			<< " elements, element " << element << " ignored" << std::endl;
+		return;
+	}
+
+	unsigned char* data = &m_Data[member.Offset + element * member.ArrayStride];
+	unsigned int columns = GetMatrixColumns(member.Type);
+	if (columns == 0)
+	{
+		memcpy(data, value, size);
+	}
+	else
+	{
+		//the C++ matrices keep their columns packed
+		unsigned int columnSize = size / columns;
+		for (unsigned int c = 0; c < columns; c++)
+			memcpy(data + c * member.MatrixStride, (const unsigned char*)value + c * columnSize, columnSize);
+	}
+	m_Dirty = true;
+}
+
+void UniformBuffer::WarnBadMember(UniformName name) const
+{
+	std::cout << "[UniformBuffer] " << m_BlockName << " has no member with hash " << std::hex << name.Hash << std::dec
+		<< " of the requested type" << std::endl;
+}
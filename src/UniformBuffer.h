@@ -0,0 +1,120 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <unordered_map>
+
+#include "Uniform.h"
+
+class Shader;
+class UniformTable;
+
+enum class BlockLayoutRule
+{
+	//uniform blocks
+	Std140,
+	//shader storage blocks, arrays of scalars and vectors are packed tighter
+	Std430
+};
+
+struct UniformBlockMember
+{
+	std::string Name;
+	unsigned long long Hash;
+	unsigned int Type;
+	unsigned int Count;
+	unsigned int Offset;
+	//0 for non-arrays
+	unsigned int ArrayStride;
+	//0 for non-matrices; matrices are laid out as arrays of column vectors
+	unsigned int MatrixStride;
+};
+
+//C++ side description of a uniform block, members pushed in declaration order
+//get the offsets the GLSL layout rule would give them
+class UniformBlockLayout
+{
+private:
+	std::vector<UniformBlockMember> m_Members;
+	unsigned int m_Size;
+	BlockLayoutRule m_Rule;
+
+public:
+	UniformBlockLayout(BlockLayoutRule rule = BlockLayoutRule::Std140)
+		:m_Size(0), m_Rule(rule) {}
+
+	template<typename T>
+	void Push(const std::string& name, unsigned int count = 1)
+	{
+		PushMember(name, UniformTraits<T>::Type, count);
+	}
+
+	//checks every member against the program's reflected offsets and strides
+	bool Validate(const UniformTable& uniforms, const std::string& blockName) const;
+
+	int Find(unsigned long long hash) const;
+	inline const std::vector<UniformBlockMember>& GetMembers() const { return m_Members; }
+	//whole block, rounded up to the alignment of a vec4 as both rules require
+	inline unsigned int GetSize() const { return (m_Size + 15) & ~15u; }
+
+private:
+	void PushMember(const std::string& name, unsigned int type, unsigned int count);
+};
+
+// GL uniform buffer holding one block. Values are written to a CPU copy and
+// sent with a single glBufferSubData by Upload(), and the buffer stays bound to
+// a fixed binding point, so every Shader that declares the block reads it
+// without per-program uploads. Shaders link their blocks to the points
+// registered here by block name, register before creating the shaders.
+class UniformBuffer
+{
+private:
+	unsigned int m_RenderID;
+	unsigned int m_Binding;
+	std::string m_BlockName;
+	UniformBlockLayout m_Layout;
+	std::vector<unsigned char> m_Data;
+	bool m_Dirty;
+
+	static std::unordered_map<std::string, unsigned int> s_Bindings;
+
+public:
+	//fixed binding points by convention
+	static const unsigned int FrameBinding = 0;
+	static const unsigned int MaterialBinding = 1;
+
+	UniformBuffer(const std::string& blockName, const UniformBlockLayout& layout, unsigned int binding);
+	~UniformBuffer();
+
+	template<typename T>
+	void Set(UniformName name, const T& value, unsigned int element = 0)
+	{
+		int member = m_Layout.Find(name.Hash);
+		if (member < 0 || !UniformTraits<T>::Matches(m_Layout.GetMembers()[member].Type))
+		{
+			WarnBadMember(name);
+			return;
+		}
+		Write(m_Layout.GetMembers()[member], element, &value, sizeof(T));
+	}
+
+	//sends the CPU copy to GL if anything changed since the last upload
+	void Upload();
+	//attaches the buffer to its binding point
+	void Bind() const;
+
+	bool Validate(const Shader& shader) const;
+
+	inline unsigned int GetBinding() const { return m_Binding; }
+	inline const std::string& GetBlockName() const { return m_BlockName; }
+
+	static void RegisterBinding(const std::string& blockName, unsigned int binding);
+	//-1 when no buffer has claimed the block name
+	static int FindBinding(const std::string& blockName);
+
+private:
+	//copies one element into the CPU copy, matrices a column at a time; elements past Count are dropped
+	void Write(const UniformBlockMember& member, unsigned int element, const void* value, unsigned int size);
+	void WarnBadMember(UniformName name) const;
+};
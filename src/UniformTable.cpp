@@ -0,0 +1,359 @@
+#include "UniformTable.h"
+#include "Render.h"
+#include "Hash.h"
+
+#include <cstring>
+
+std::unordered_map<unsigned int, std::shared_ptr<std::vector<unsigned char>>> UniformTable::s_ProgramShadows;
+
+void UniformTable::Reflect(unsigned int program, const UniformTable* previous)
+{
+	Reflect(&program, 1, previous);
+}
+
+void UniformTable::Reflect(const unsigned int* programs, unsigned int count, const UniformTable* previous)
+{
+	Clear();
+
+	std::vector<UniformInfo> copies;
+	std::unordered_map<unsigned long long, int> handles;
+	for (unsigned int p = 0; p < count; p++)
+	{
+		unsigned int program = programs[p];
+		int blockBase = (int)m_Blocks.size();
+		unsigned int shadowSize = 0;
+
+		int blockCount = 0;
+		GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+		for (int i = 0; i < blockCount; i++)
+		{
+			char name[256];
+			int length = 0;
+			int dataSize = 0;
+			GLCall(glGetActiveUniformBlockName(program, i, sizeof(name), &length, name));
+			GLCall(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize));
+			m_Blocks.push_back({ std::string(name, length), HashBytes(name, length), (unsigned int)i, dataSize, program });
+		}
+
+		int uniformCount = 0;
+		GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount));
+		m_Uniforms.reserve(m_Uniforms.size() + uniformCount);
+		for (int i = 0; i < uniformCount; i++)
+		{
+			char name[256];
+			int length = 0;
+			int size = 0;
+			GLenum type = 0;
+			GLCall(glGetActiveUniform(program, i, sizeof(name), &length, &size, &type, name));
+
+			//arrays are reported as "u_Name[0]", look them up by the bare name
+			if (length > 3 && strcmp(name + length - 3, "[0]") == 0)
+			{
+				length -= 3;
+				name[length] = '\0';
+			}
+
+			GLuint index = i;
+			int block = -1, offset = -1, arrayStride = -1, matrixStride = -1;
+			GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block));
+			GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &offset));
+			GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_ARRAY_STRIDE, &arrayStride));
+			GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_MATRIX_STRIDE, &matrixStride));
+
+			int location = -1;
+			if (block < 0)
+			{
+				GLCall(location = glGetUniformLocation(program, name));
+			}
+
+			if (block >= 0)
+				block += blockBase;
+			UniformInfo info = { std::string(name, length), HashBytes(name, length), type, size,
+				location, block, offset, arrayStride, matrixStride, 0, 0, program, -1 };
+
+			//block members live in buffers, their values are not ours to shadow
+			info.ShadowOffset = shadowSize;
+			info.ShadowSize = block < 0 ? GetTypeSize(type) * size : 0;
+			if (info.ShadowSize)
+				shadowSize += 1 + info.ShadowSize;
+
+			//a later stage declaring the same uniform only adds a location to upload to
+			auto found = handles.find(info.Hash);
+			if (found != handles.end())
+			{
+				info.Next = found->second;
+				copies.push_back(info);
+				continue;
+			}
+
+			handles[info.Hash] = (int)m_Uniforms.size();
+			m_Uniforms.push_back(info);
+		}
+		AttachShadow(program, shadowSize);
+	}
+
+	Finish(copies, previous);
+}
+
+void UniformTable::Assign(unsigned int program, const std::vector<UniformInfo>& uniforms, const std::vector<SpirvBlock>& blocks,
+	const UniformTable* previous)
+{
+	Clear();
+
+	int blockCount = 0;
+	GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+	for (int i = 0; i < blockCount; i++)
+	{
+		int binding = -1;
+		int dataSize = 0;
+		GLCall(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_BINDING, &binding));
+		GLCall(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize));
+		for (const SpirvBlock& block : blocks)
+		{
+			if ((int)block.Binding == binding)
+				m_Blocks.push_back({ block.Name, HashBytes(block.Name.data(), block.Name.size()), (unsigned int)i, dataSize, program });
+		}
+	}
+
+	unsigned int shadowSize = 0;
+	for (UniformInfo info : uniforms)
+	{
+		info.Program = program;
+		info.Next = -1;
+		info.ShadowOffset = shadowSize;
+		info.ShadowSize = info.Block < 0 ? GetTypeSize(info.Type) * info.Size : 0;
+		if (info.ShadowSize)
+			shadowSize += 1 + info.ShadowSize;
+		m_Uniforms.push_back(info);
+	}
+	AttachShadow(program, shadowSize);
+
+	std::vector<UniformInfo> copies;
+	Finish(copies, previous);
+}
+
+void UniformTable::Finish(std::vector<UniformInfo>& copies, const UniformTable* previous)
+{
+	//uniforms the previous table had keep their handle, ones that are gone stay behind
+	//without a location so setting them does nothing, new ones go after both
+	if (previous && previous->m_HandleCount > 0)
+	{
+		std::vector<UniformInfo> ordered;
+		for (unsigned int i = 0; i < previous->m_HandleCount; i++)
+		{
+			UniformInfo gone = previous->m_Uniforms[i];
+			gone.Location = -1;
+			gone.Block = -1;
+			gone.ShadowSize = 0;
+			gone.Next = -1;
+			ordered.push_back(gone);
+		}
+
+		std::vector<int> remap(m_Uniforms.size());
+		for (unsigned int i = 0; i < m_Uniforms.size(); i++)
+		{
+			int kept = previous->Find(m_Uniforms[i].Hash);
+			remap[i] = kept >= 0 ? kept : (int)ordered.size();
+			if (kept >= 0)
+				ordered[kept] = m_Uniforms[i];
+			else
+				ordered.push_back(m_Uniforms[i]);
+		}
+		m_Uniforms.swap(ordered);
+		for (UniformInfo& copy : copies)
+			copy.Next = remap[copy.Next];
+	}
+
+	//copies go behind the handles so the perfect hash only ever sees one entry per name;
+	//Next was borrowed above to remember the handle, now it links the chain
+	m_HandleCount = (unsigned int)m_Uniforms.size();
+	for (UniformInfo& copy : copies)
+	{
+		int last = copy.Next;
+		while (m_Uniforms[last].Next >= 0)
+			last = m_Uniforms[last].Next;
+		copy.Next = -1;
+		m_Uniforms[last].Next = (int)m_Uniforms.size();
+		m_Uniforms.push_back(copy);
+	}
+
+	m_ShadowEntries.assign(m_Uniforms.size(), nullptr);
+	for (unsigned int i = 0; i < m_Uniforms.size(); i++)
+	{
+		const UniformInfo& info = m_Uniforms[i];
+		if (info.ShadowSize)
+			m_ShadowEntries[i] = s_ProgramShadows[info.Program]->data() + info.ShadowOffset;
+	}
+
+	BuildPerfectHash();
+}
+
+void UniformTable::AttachShadow(unsigned int program, unsigned int size)
+{
+	//reflecting a program enumerates its uniforms in the same order every time,
+	//so a table that reflected it before laid out the same shadow
+	std::shared_ptr<std::vector<unsigned char>>& shadow = s_ProgramShadows[program];
+	if (!shadow || shadow->size() != size)
+		shadow = std::make_shared<std::vector<unsigned char>>(size, 0);
+	m_ProgramShadows.push_back(shadow);
+}
+
+void UniformTable::ForgetProgram(unsigned int program)
+{
+	//tables still holding the shadow keep it, a new program under this name starts over
+	s_ProgramShadows.erase(program);
+}
+
+void UniformTable::Clear()
+{
+	m_Uniforms.clear();
+	m_Blocks.clear();
+	m_Slots.clear();
+	m_ProgramShadows.clear();
+	m_ShadowEntries.clear();
+	m_HandleCount = 0;
+	m_Seed = 0;
+	m_Mask = 0;
+}
+
+int UniformTable::Reserve(unsigned long long hash, const char* name)
+{
+	int handle = Find(hash);
+	if (handle >= 0)
+		return handle;
+
+	//handles are the front of m_Uniforms, a copy behind them would get renumbered
+	ASSERT(m_HandleCount == m_Uniforms.size());
+	UniformInfo info = { name ? name : "", hash, 0, 1, -1, -1, -1, -1, -1, 0, 0, 0, -1 };
+	m_Uniforms.push_back(info);
+	m_ShadowEntries.push_back(nullptr);
+	m_HandleCount = (unsigned int)m_Uniforms.size();
+	BuildPerfectHash();
+	return (int)m_HandleCount - 1;
+}
+
+bool UniformTable::UpdateShadow(int handle, const void* value, unsigned int size)
+{
+	//every program the uniform lives in must hold the value already, other shaders may share them
+	bool changed = false;
+	for (int i = handle; i >= 0; i = m_Uniforms[i].Next)
+	{
+		unsigned char* entry = m_ShadowEntries[i];
+		//unknown types always go through
+		if (!entry || size > m_Uniforms[i].ShadowSize)
+		{
+			changed = true;
+			continue;
+		}
+		if (entry[0] && memcmp(entry + 1, value, size) == 0)
+			continue;
+
+		//a partial array upload patches the front; the shadow is only whole if the rest already was
+		if (size == m_Uniforms[i].ShadowSize)
+			entry[0] = 1;
+		memcpy(entry + 1, value, size);
+		changed = true;
+	}
+	return changed;
+}
+
+const void* UniformTable::GetShadow(int handle) const
+{
+	const unsigned char* entry = m_ShadowEntries[handle];
+	if (!entry || !entry[0])
+		return nullptr;
+	return entry + 1;
+}
+
+unsigned int UniformTable::GetTypeSize(unsigned int type)
+{
+	switch (type)
+	{
+	case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL:
+	case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+	case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_SHADOW:
+		return 4;
+	case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2:
+		return 8;
+	case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3:
+		return 12;
+	case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4:
+	case GL_FLOAT_MAT2:
+		return 16;
+	case GL_FLOAT_MAT3:
+		return 36;
+	case GL_FLOAT_MAT4:
+		return 64;
+	}
+	return 0;
+}
+
+unsigned int UniformTable::Slot(unsigned long long hash, unsigned long long seed, unsigned int mask)
+{
+	//64-bit finalizer, spreads the seed change over every bit before masking
+	unsigned long long h = hash ^ seed;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	return (unsigned int)h & mask;
+}
+
+void UniformTable::BuildPerfectHash()
+{
+	if (m_HandleCount == 0)
+		return;
+
+	//start at twice the uniform count and grow until some seed maps every name to its own slot
+	unsigned int size = 1;
+	while (size < m_HandleCount * 2)
+		size <<= 1;
+
+	for (;;)
+	{
+		m_Mask = size - 1;
+		for (unsigned long long seed = 0; seed < 256; seed++)
+		{
+			m_Slots.assign(size, -1);
+			bool collided = false;
+			for (unsigned int i = 0; i < m_HandleCount && !collided; i++)
+			{
+				int& slot = m_Slots[Slot(m_Uniforms[i].Hash, seed, m_Mask)];
+				collided = slot != -1;
+				slot = i;
+			}
+			if (!collided)
+			{
+				m_Seed = seed;
+				return;
+			}
+		}
+		size <<= 1;
+	}
+}
+
+int UniformTable::Find(unsigned long long hash) const
+{
+	if (m_Slots.empty())
+		return -1;
+
+	int handle = m_Slots[Slot(hash, m_Seed, m_Mask)];
+	return handle >= 0 && m_Uniforms[handle].Hash == hash ? handle : -1;
+}
+
+int UniformTable::Find(const char* name) const
+{
+	int handle = Find(HashBytes(name, strlen(name)));
+	//a 64-bit hash match is as good as a name match, but a miss must not alias another uniform
+	return handle >= 0 && m_Uniforms[handle].Name == name ? handle : -1;
+}
+
+int UniformTable::FindBlock(const char* name) const
+{
+	unsigned long long hash = HashBytes(name, strlen(name));
+	for (unsigned int i = 0; i < m_Blocks.size(); i++)
+	{
+		if (m_Blocks[i].Hash == hash && m_Blocks[i].Name == name)
+			return i;
+	}
+	return -1;
+}
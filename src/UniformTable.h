@@ -0,0 +1,125 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+struct UniformInfo
+{
+	std::string Name;
+	unsigned long long Hash;
+	//GL type enum, e.g. GL_FLOAT_VEC4
+	unsigned int Type;
+	//array length, 1 for plain uniforms
+	int Size;
+	//-1 for members of a uniform block
+	int Location;
+	//index into the block list, -1 in the default block
+	int Block;
+	//byte layout inside the block, -1 in the default block
+	int Offset;
+	int ArrayStride;
+	int MatrixStride;
+	//where the last uploaded value lives in its program's shadow (after a valid flag byte),
+	//ShadowSize 0 when not shadowed
+	unsigned int ShadowOffset;
+	unsigned int ShadowSize;
+	//program the location belongs to
+	unsigned int Program;
+	//the same uniform in a later stage program of a pipeline, -1 at the end of the chain
+	int Next;
+};
+
+struct UniformBlockInfo
+{
+	std::string Name;
+	unsigned long long Hash;
+	unsigned int Index;
+	int DataSize;
+	unsigned int Program;
+};
+
+//uniform block of a program GL cannot name (SPIR-V), recognized by the binding it was compiled with
+struct SpirvBlock
+{
+	std::string Name;
+	unsigned int Binding;
+};
+
+// Flat table of a linked program's active uniforms and uniform blocks, filled
+// by reflection at link time. Names map to table indices ("handles") through a
+// perfect hash built over the name hashes, so a lookup is one probe and one
+// compare; the per-frame path should resolve handles once and keep them.
+// Every default-block uniform's last uploaded value is kept on the CPU so
+// setters can skip uploads that would not change anything. The copy belongs to
+// the GL program, not the table: tables reflecting the same program (Separable
+// shaders sharing a stage) see each other's uploads instead of going stale.
+// Reflecting the stage programs of a pipeline merges them: a uniform declared
+// in several stages gets one handle, and the copies in later stages follow it
+// through UniformInfo::Next.
+// Reflecting with the previous table of the same shader (after a reload)
+// keeps every handle resolved against it pointing at the same uniform.
+class UniformTable
+{
+private:
+	std::vector<UniformInfo> m_Uniforms;
+	std::vector<UniformBlockInfo> m_Blocks;
+	//uniforms that own a handle come first, the Next copies after them
+	unsigned int m_HandleCount;
+	//perfect hash slots holding uniform indices, -1 when empty
+	std::vector<int> m_Slots;
+	//keeps the shadows of the reflected programs alive
+	std::vector<std::shared_ptr<std::vector<unsigned char>>> m_ProgramShadows;
+	//per uniform (copies too), its valid flag followed by its value, nullptr when not shadowed
+	std::vector<unsigned char*> m_ShadowEntries;
+	unsigned long long m_Seed;
+	unsigned int m_Mask;
+
+public:
+	UniformTable()
+		:m_HandleCount(0), m_Seed(0), m_Mask(0) {}
+
+	void Reflect(unsigned int program, const UniformTable* previous = nullptr);
+	void Reflect(const unsigned int* programs, unsigned int count, const UniformTable* previous = nullptr);
+	//takes the uniforms from elsewhere when GL cannot name them, e.g. a SPIR-V program;
+	//the program's active blocks get their names from blocks by matching the binding
+	void Assign(unsigned int program, const std::vector<UniformInfo>& uniforms, const std::vector<SpirvBlock>& blocks,
+		const UniformTable* previous = nullptr);
+	void Clear();
+	//handle for a uniform of a program that is not there yet (async compiles): no location, type or
+	//shadow; reflecting the program with this table as previous keeps the handle. Table without copies only
+	int Reserve(unsigned long long hash, const char* name);
+
+	//handle of the uniform, -1 when the program has no such active uniform
+	int Find(const char* name) const;
+	int Find(unsigned long long hash) const;
+	//index of the uniform block, -1 when the program does not declare it
+	int FindBlock(const char* name) const;
+
+	inline const UniformInfo& Get(int handle) const { return m_Uniforms[handle]; }
+	//handles run from 0 to GetHandleCount() - 1
+	inline unsigned int GetHandleCount() const { return m_HandleCount; }
+
+	//stores value as the uniform's shadow, size may cover only the first elements of an array;
+	//false when it is bit-identical to the last upload
+	bool UpdateShadow(int handle, const void* value, unsigned int size);
+	//last uploaded value, nullptr when nothing was uploaded since the program was linked
+	const void* GetShadow(int handle) const;
+	//bytes of one element of a GL uniform type, 0 for types we do not shadow
+	static unsigned int GetTypeSize(unsigned int type);
+	//call when a reflected program is deleted, GL may hand its name out again
+	static void ForgetProgram(unsigned int program);
+	inline const std::vector<UniformInfo>& GetUniforms() const { return m_Uniforms; }
+	inline const std::vector<UniformBlockInfo>& GetBlocks() const { return m_Blocks; }
+
+private:
+	//orders handles after previous, chains the copies and builds the lookup
+	void Finish(std::vector<UniformInfo>& copies, const UniformTable* previous);
+	//the program's shadow, created (all invalid) unless another table already reflected it
+	void AttachShadow(unsigned int program, unsigned int size);
+	static unsigned int Slot(unsigned long long hash, unsigned long long seed, unsigned int mask);
+	void BuildPerfectHash();
+
+	static std::unordered_map<unsigned int, std::shared_ptr<std::vector<unsigned char>>> s_ProgramShadows;
+};
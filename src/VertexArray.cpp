@@ -1,14 +1,18 @@
 #include "VertexArray.h"
 #include "Render.h"
 #include "VertexBufferLayout.h"
+#include "GLState.h"
+#include "StreamingBuffer.h"
 
 VertexArray::VertexArray()
+	:m_AttribCount(0)
 {
 	GLCall(glGenVertexArrays(1, &m_RendererID));
 }
 
 VertexArray::~VertexArray()
 {
+	GLState::OnDeleteVertexArray(m_RendererID);
 	GLCall(glDeleteVertexArrays(1, &m_RendererID));
 }
 
@@ -16,27 +20,44 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 {
 	Bind();
 	vb.Bind();
+	AddAttributes(layout);
+}
+
+void VertexArray::AddBuffer(const StreamingBuffer& sb, const VertexBufferLayout& layout)
+{
+	Bind();
+	sb.Bind();
+	AddAttributes(layout);
+}
+
+void VertexArray::AddAttributes(const VertexBufferLayout& layout)
+{
 	const auto& elements = layout.GetElements();
 	unsigned int offset = 0;
 	for (unsigned int i = 0; i < elements.size(); i++)
 	{
+		//attribute slots continue after the ones used by earlier buffers
+		unsigned int index = m_AttribCount + i;
 		const auto& element = elements[i];
-		GLCall(glEnableVertexAttribArray(i));
-		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, 
+		GLCall(glEnableVertexAttribArray(index));
+		GLCall(glVertexAttribPointer(index, element.count, element.type, element.normalized, 
 			layout.GetStride(), (const void*)offset));
+		if (layout.GetDivisor() != 0)
+		{
+			GLCall(glVertexAttribDivisor(index, layout.GetDivisor()));
+		}
 
 		offset += element.count * VertexBufferLayoutElement::GetSizeOfType(element.type);
 	}
-
-
+	m_AttribCount += (unsigned int)elements.size();
 }
 
 void VertexArray::Bind() const
 {
-	GLCall(glBindVertexArray(m_RendererID));
+	GLState::BindVertexArray(m_RendererID);
 }
 
 void VertexArray::UnBind() const
 {
-	GLCall(glBindVertexArray(0));
+	GLState::BindVertexArray(0);
 }
@@ -4,18 +4,28 @@
 
 
 class VertexBufferLayout;
+class StreamingBuffer;
 
 class VertexArray
 {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_AttribCount;
 
 public:
 	VertexArray();
 	~VertexArray();
 
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	//attributes start at offset 0, draw with the first vertex taken from StreamingBuffer::Unmap()
+	void AddBuffer(const StreamingBuffer& sb, const VertexBufferLayout& layout);
 	void Bind() const;
 	void UnBind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+private:
+	//points the next free attribute slots at the bound GL_ARRAY_BUFFER
+	void AddAttributes(const VertexBufferLayout& layout);
 };
 
@@ -1,24 +1,73 @@
 #include "VertexBuffer.h"
 #include  "Render.h"
+#include "GLState.h"
 
-VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+VertexBuffer::VertexBuffer(const void* data, unsigned int size, BufferUsage usage)
+	:m_Stride(0), m_Range({ 0, 0, size }), m_Arena(nullptr), m_Usage(usage), m_Strategy(GetDefaultUpdateStrategy(usage))
 {
 	GLCall(glGenBuffers(1, &m_RenderID));
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RenderID));
-	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	GLState::BindArrayBuffer(m_RenderID);
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GetBufferUsageHint(usage)));
+}
+
+VertexBuffer::VertexBuffer(BufferArena& arena, const void* data, unsigned int size, unsigned int stride)
+	:m_Stride(stride), m_Range(arena.Allocate(size, stride)), m_Arena(&arena), m_Usage(arena.GetUsage()),
+	m_Strategy(GetDefaultUpdateStrategy(arena.GetUsage()))
+{
+	m_RenderID = arena.GetRendererID(m_Range.Page);
+	arena.Upload(m_Range, 0, data, size);
 }
 
 VertexBuffer::~VertexBuffer()
 {
+	if (m_Arena)
+	{
+		m_Arena->Free(m_Range);
+		return;
+	}
+	GLState::OnDeleteBuffer(m_RenderID);
 	GLCall(glDeleteBuffers(1, &m_RenderID));
 }
 
+void VertexBuffer::Update(const void* data, unsigned int size)
+{
+	if (size <= m_Range.Size)
+	{
+		UpdateRange(0, data, size);
+		return;
+	}
+
+	if (m_Arena)
+	{
+		m_Arena->Free(m_Range);
+		m_Range = m_Arena->Allocate(size, m_Stride);
+		m_RenderID = m_Arena->GetRendererID(m_Range.Page);
+		m_Arena->Upload(m_Range, 0, data, size);
+		return;
+	}
+
+	//every strategy needs new storage to grow
+	m_Range.Size = size;
+	GLState::BindArrayBuffer(m_RenderID);
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GetBufferUsageHint(m_Usage)));
+}
+
+void VertexBuffer::UpdateRange(unsigned int offset, const void* data, unsigned int size)
+{
+	ASSERT(offset + size <= m_Range.Size);
+
+	if (m_Arena)
+		m_Arena->Upload(m_Range, offset, data, size, m_Strategy);
+	else
+		UpdateBuffer(m_RenderID, m_Range.Size, offset, data, size, m_Usage, m_Strategy);
+}
+
 void VertexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RenderID));
+	GLState::BindArrayBuffer(m_RenderID);
 }
 
 void VertexBuffer::UnBind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	GLState::BindArrayBuffer(0);
 }
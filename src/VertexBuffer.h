@@ -1,16 +1,46 @@
 #pragma once
 
+#include "BufferArena.h"
+
+//either owns its GL buffer or is a view of a range in a BufferArena
 class VertexBuffer
 {
 private:
 	unsigned int m_RenderID;
+	unsigned int m_Stride;
+	BufferRange m_Range;
+	BufferArena* m_Arena;
+	BufferUsage m_Usage;
+	BufferUpdateStrategy m_Strategy;
 
 public:
-	VertexBuffer(const void* data, unsigned int size);
+	VertexBuffer(const void* data, unsigned int size, BufferUsage usage = BufferUsage::Static);
+	//the range starts on a whole vertex, draw with GetBaseVertex()
+	VertexBuffer(BufferArena& arena, const void* data, unsigned int size, unsigned int stride);
 	~VertexBuffer();
 
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+
+	//replaces the contents, growing the buffer when size exceeds it; an arena view that
+	//grows moves to a new range, so re-read GetRendererID() and GetBaseVertex()
+	void Update(const void* data, unsigned int size);
+	//writes size bytes at offset, the range must lie inside the buffer
+	void UpdateRange(unsigned int offset, const void* data, unsigned int size);
+
+	//starts out as GetDefaultUpdateStrategy(usage)
+	inline void SetUpdateStrategy(BufferUpdateStrategy strategy) { m_Strategy = strategy; }
+	inline BufferUpdateStrategy GetUpdateStrategy() const { return m_Strategy; }
+
 	void Bind() const;
 	void UnBind() const;
 
+	inline unsigned int GetRendererID() const { return m_RenderID; }
+	inline unsigned int GetOffset() const { return m_Range.Offset; }
+	inline unsigned int GetSize() const { return m_Range.Size; }
+	inline BufferUsage GetUsage() const { return m_Usage; }
+	//index of the first vertex in the GL buffer, 0 unless the buffer comes from an arena
+	inline int GetBaseVertex() const { return m_Stride ? (int)(m_Range.Offset / m_Stride) : 0; }
+
 
 };
@@ -15,9 +15,9 @@ struct VertexBufferLayoutElement
 		{
 		case GL_FLOAT:
 			return 4;
-		case GL_UNSIGNED_INT:
-			return 4;
-		case GL_UNSIGNED_BYTE:
+		case GL_UNSIGNED_INT:
+			return 4;
+		case GL_UNSIGNED_BYTE:
 			return 1;
 		}
 
@@ -31,10 +31,12 @@ class VertexBufferLayout
 private:
 	std::vector<VertexBufferLayoutElement> m_Elements;
 	unsigned int m_Stride;
+	unsigned int m_Divisor;
 
 public:
-	VertexBufferLayout()
-		:m_Stride(0) {}
+	//divisor 0 advances the attributes per vertex, N advances them once every N instances
+	explicit VertexBufferLayout(unsigned int divisor = 0)
+		:m_Stride(0), m_Divisor(divisor) {}
 
 	template<typename T>
 	void Push(unsigned int count)
@@ -63,6 +65,14 @@ public:
 		m_Stride += count * VertexBufferLayoutElement::GetSizeOfType(GL_UNSIGNED_BYTE);
 	}
 
+	//a mat4 attribute occupies four consecutive vec4 attribute slots
+	void PushMat4()
+	{
+		for (int column = 0; column < 4; column++)
+			Push<float>(4);
+	}
+
 	inline const std::vector<VertexBufferLayoutElement> GetElements() const { return m_Elements; }
 	inline unsigned int GetStride() const { return m_Stride; }
+	inline unsigned int GetDivisor() const { return m_Divisor; }
 };